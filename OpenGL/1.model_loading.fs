@@ -1,190 +1,32 @@
 #version 460 core
-out vec4 FragColor;
+layout (location = 0) out vec4 FragColor;
 
-in vec3 FragPos;
-in vec3 Normal;
-in vec2 TexCoords;
+layout (location = 0) in vec3 FragPos;
+layout (location = 1) in vec3 Normal;
+layout (location = 2) in vec2 TexCoords;
 
-uniform sampler2D texture_diffuse1;
-uniform sampler2D texture_specular1;
-uniform sampler2D texture_normal1;
-uniform float shininess;
+layout (location = 2) uniform sampler2D texture_diffuse1;
+layout (location = 3) uniform sampler2D texture_specular1;
+layout (location = 1) uniform float shininess;
 
-struct DirLight {
-    vec3 direction;
-	
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
+#ifdef LIGHTMAP
+layout (location = 3) in vec2 LightmapCoords;
+// baked by lightmap_baker: rgb the static point lights' irradiance, a ambient occlusion
+layout (binding = 10) uniform sampler2D lightmap;
+// the point lights below this index are in the lightmap
+layout (location = 13) uniform int bakedPointLights;
+#endif
 
-struct PointLight {
-    vec3 position;
-    
-    float constant;
-    float linear;
-    float quadratic;
-	
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-struct SpotLight {
-    vec3 position;
-    vec3 direction;
-    float cutOff;
-    float outerCutOff;
-  
-    float constant;
-    float linear;
-    float quadratic;
-  
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;       
-};
-
-#define NR_POINT_LIGHTS 2
-#define NR_SPOTLIGHTS 2
-
-uniform vec3 viewPos;
-uniform DirLight dirLight;
-uniform PointLight pointLights[NR_POINT_LIGHTS];
-uniform SpotLight spotLights[NR_SPOTLIGHTS];
-uniform vec3 fogColor;
-uniform float fogIntensity;
-uniform bool blinn;
-
-// function prototypes
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-float CalcFogFactor(vec3 worldPos);
+#include "lighting.glsl"
 
 void main()
-{    
-
-    // properties
-    vec3 norm = normalize(Normal);
-    vec3 viewDir = normalize(viewPos - FragPos);
-    
-    // == =====================================================
-    // Our lighting is set up in 3 phases: directional, point lights and an optional flashlight
-    // For each phase, a calculate function is defined that calculates the corresponding color
-    // per lamp. In the main() function we take all the calculated colors and sum them up for
-    // this fragment's final color.
-    // == =====================================================
-    // phase 1: directional lighting
-    vec3 result = CalcDirLight(dirLight, norm, viewDir);
-    // phase 2: point lights
-    for(int i = 0; i < NR_POINT_LIGHTS; i++)
-        result += CalcPointLight(pointLights[i], norm, FragPos, viewDir);    
-    // phase 3: spot light
-    for(int i = 0; i < NR_SPOTLIGHTS; i++)
-        result += CalcSpotLight(spotLights[i], norm, FragPos, viewDir);  
-    
-    float fog_factor = CalcFogFactor(FragPos);
-    result = mix(fogColor, result, fog_factor);
-
-    FragColor = vec4(result, 1.0);
-}
-
-// calculates the color when using a directional light.
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
 {
-    vec3 lightDir = normalize(-light.direction);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = 0.0;
-    if (blinn)
-    {
-        spec = pow(max(dot(normal, normalize(lightDir + viewDir)), 0.0), shininess);
-    }
-    else
-    {
-        spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
-    }
-    // combine results
-    vec3 ambient = light.ambient * vec3(texture(texture_diffuse1, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(texture_diffuse1, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(texture_specular1, TexCoords));
-    return (ambient + diffuse + specular);
+    Material material = MakeMaterial(vec3(texture(texture_diffuse1, TexCoords)),
+                                     vec3(texture(texture_specular1, TexCoords)), shininess);
+#ifdef LIGHTMAP
+    vec4 baked = texture(lightmap, LightmapCoords);
+    FragColor = vec4(ShadeForward(material, normalize(Normal), FragPos, BakedLight(baked.rgb, dirLight.ambient * baked.a, bakedPointLights)), 1.0);
+#else
+    FragColor = vec4(ShadeForward(material, normalize(Normal), FragPos), 1.0);
+#endif
 }
-
-// calculates the color when using a point light.
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
-{
-    vec3 lightDir = normalize(light.position - fragPos);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = 0.0;
-    if (blinn)
-    {
-        spec = pow(max(dot(normal, normalize(lightDir + viewDir)), 0.0), shininess);
-    }
-    else
-    {
-        spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
-    }
-    // attenuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
-    // combine results
-    vec3 ambient = light.ambient * vec3(texture(texture_diffuse1, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(texture_diffuse1, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(texture_specular1, TexCoords));
-    ambient *= attenuation;
-    diffuse *= attenuation;
-    specular *= attenuation;
-    return (ambient + diffuse + specular);
-}
-
-// calculates the color when using a spot light.
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
-{
-    vec3 lightDir = normalize(light.position - fragPos);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = 0.0;
-    if (blinn)
-    {
-        spec = pow(max(dot(normal, normalize(lightDir + viewDir)), 0.0), shininess);
-    }
-    else
-    {
-        spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
-    }
-    // attenuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
-    // spotlight intensity
-    float theta = dot(lightDir, normalize(-light.direction)); 
-    //float epsilon = light.cutOff - light.outerCutOff;
-    //float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
-    float intensity = pow(max(theta, 0.0), 32);
-    // combine results
-    vec3 ambient = light.ambient * vec3(texture(texture_diffuse1, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(texture_diffuse1, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(texture_specular1, TexCoords));
-    ambient *= attenuation * intensity;
-    diffuse *= attenuation * intensity;
-    specular *= attenuation * intensity;
-    return (ambient + diffuse + specular);
-}
-
-float CalcFogFactor(vec3 fragPos)
-{
-    if (fogIntensity == 0) return 1;
-    float gradient = (fogIntensity * fogIntensity - 50 * fogIntensity + 60);
-    float distance = length(viewPos - fragPos);
-    float fog = exp(-pow((distance / gradient), 4));
-    fog = clamp(fog, 0.0, 1.0);
-    return fog;
-}
\ No newline at end of file
@@ -2,20 +2,35 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+#ifdef LIGHTMAP
+// Mesh::setLightmapCoords
+layout (location = 7) in vec2 aLightmapCoords;
+#endif
 
-out vec3 FragPos;
-out vec3 Normal;
-out vec2 TexCoords;
+layout (location = 0) out vec3 FragPos;
+layout (location = 1) out vec3 Normal;
+layout (location = 2) out vec2 TexCoords;
+#ifdef LIGHTMAP
+layout (location = 3) out vec2 LightmapCoords;
+#endif
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (location = 0) uniform mat4 model;
+
+layout (std140, binding = 0) uniform Camera
+{
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
 
 void main()
 {
     FragPos = vec3(model * vec4(aPos, 1.0));
     Normal = mat3(transpose(inverse(model))) * aNormal;  
     TexCoords = aTexCoords;
+#ifdef LIGHTMAP
+    LightmapCoords = aLightmapCoords;
+#endif
     
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
\ No newline at end of file
@@ -1,9 +1,14 @@
 #version 460 core
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (location = 0) uniform mat4 model;
+
+layout (std140, binding = 0) uniform Camera
+{
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
 
 void main()
 {
@@ -3,13 +3,18 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 
-out vec3 FragPos;
-out vec3 Normal;
-out vec2 TexCoords;
+layout (location = 0) out vec3 FragPos;
+layout (location = 1) out vec3 Normal;
+layout (location = 2) out vec2 TexCoords;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (location = 0) uniform mat4 model;
+
+layout (std140, binding = 0) uniform Camera
+{
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
 
 void main()
 {
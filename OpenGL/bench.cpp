@@ -0,0 +1,630 @@
+// Headless benchmark: builds the same Scene as main.cpp inside an offscreen EGL context
+// (surfaceless, so it also runs on Mesa llvmpipe without a GPU or display), renders a
+// fixed number of frames at a fixed resolution and prints load and frame times as JSON.
+//
+// usage: bench [--width W] [--height H] [--frames N] [--warmup N] [--data DIR]
+//              [--replay FILE [--timestep SECONDS]] [--trace FILE] [--mock-gl] [--keep-geometry]
+//              [--lights N] [--spotlights N] [--clustered [--heatmap]] [--object-lights] [--deferred]
+//              [--no-program-cache] [--serial-shaders] [--no-uniform-shadow] [--no-spirv]
+//              [--no-shadows] [--cascades N] [--shadow-resolution N] [--cached-cascades N]
+//              [--shadow-interval N] [--shadow-budget MS] [--no-spot-shadows] [--no-static-cache]
+//              [--no-lightmap] [--no-probes]
+//
+// With --replay the car, cameras, fog and time of day follow an input log recorded by
+// the interactive executable (main --record FILE); the run stops early at the end of the log.
+// --trace writes the CPU profiler zones as Chrome trace JSON (build with -DENABLE_PROFILER=ON).
+// --mock-gl replaces the driver with the no-op GL of learnopengl/mock_gl.h: no EGL, GPU or
+// display is needed, frame times are pure CPU submission cost and the report adds per-frame
+// GL call counts. The run fails if it counted no uniform uploads.
+// --keep-geometry keeps the models' CPU copies of vertices and indices, as before they were freed.
+// --lights / --spotlights add N point lights / spotlights to the scene to measure how the frame
+// time scales with the number of lights (Scene::addStressLights).
+// --clustered culls the lights into froxels with a compute pass first (light_clusters.h);
+// --heatmap then renders the number of lights per froxel instead of the lit scene.
+// --object-lights gives every forward draw only the lights whose range reaches its bounds
+// (object_lights.h); "lights" then reports the lights per draw.
+// --deferred renders through the G-buffer and light volumes of deferred_renderer.h.
+// --no-program-cache compiles every shader from source instead of loading the program binaries
+// cached in shader_cache/ by earlier runs (learnopengl/program_cache.h).
+// --serial-shaders waits for every shader right after submitting it instead of once the models
+// are loaded (learnopengl/shader_compiler.h); the "shaders" report of both runs shows the
+// startup time the overlap saves.
+// --no-uniform-shadow sends every uniform value, including those a program already holds
+// (Shader::shadowUniforms); "uniforms" reports the uploads sent and skipped per measured frame.
+// --no-spirv compiles the GLSL even when the build compiled the shaders to SPIR-V
+// (Shader::spirvDirectory, needs glslangValidator at build time and GL 4.6 at run time).
+// --no-shadows turns off the sun's cascaded shadow maps (shadow_cascades.h); --cascades,
+// --shadow-resolution, --cached-cascades, --shadow-interval and --shadow-budget (GPU ms, 0: none)
+// override their settings. "shadows" reports the cascades rendered per measured frame and the
+// cached ones deferred by the budget.
+// --no-spot-shadows turns off the headlights' shadow maps (spot_shadows.h); --no-static-cache
+// redraws de_dust2 into them every frame instead of keeping it until the car moves.
+// "spot_shadows" reports the static maps redrawn per measured frame.
+// --no-lightmap shades de_dust2's static lights per fragment even when lightmap_baker has baked
+// them (lightmap.h); "lightmap" reports whether one was loaded and used.
+// --no-probes gives the containers, the car and the flag the sun's flat ambient even when
+// probe_baker has baked irradiance probes (irradiance_probes.h); "probes" reports whether they
+// were loaded and used.
+
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "scene.h"
+#include "input.h"
+
+#include <learnopengl/mock_gl.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#ifndef OPENGL_DATA_DIR
+#define OPENGL_DATA_DIR "."
+#endif
+
+// without a replay the scene advances by a fixed step per frame so every run renders the same frames
+const float SIM_TIMESTEP = 1.0f / 60.0f;
+
+struct BenchOptions
+{
+    unsigned int width = 1920;
+    unsigned int height = 1080;
+    int frames = 600;
+    int warmup = 30;
+    std::string dataDir = OPENGL_DATA_DIR;
+    std::string replayPath;
+    float timestep = 0.0f;
+    std::string tracePath;
+    bool mockGl = false;
+    bool keepGeometry = false;
+    int pointLights = 0;
+    int spotlights = 0;
+    bool clustered = false;
+    bool heatmap = false;
+    bool objectLights = false;
+    bool deferred = false;
+    bool programCache = true;
+    bool serialShaders = false;
+    bool uniformShadow = true;
+    bool spirv = true;
+    bool shadows = true;
+    // -1 keeps the ShadowCascades default
+    int cascades = -1;
+    int shadowResolution = -1;
+    int cachedCascades = -1;
+    int shadowInterval = -1;
+    float shadowBudget = -1.0f;
+    bool spotShadows = true;
+    bool staticCache = true;
+    bool lightmap = true;
+    bool probes = true;
+};
+
+static void printUsage()
+{
+    std::cerr << "usage: bench [--width W] [--height H] [--frames N] [--warmup N] [--data DIR]"
+                 " [--replay FILE [--timestep SECONDS]] [--trace FILE] [--mock-gl] [--keep-geometry]"
+                 " [--lights N] [--spotlights N] [--clustered [--heatmap]] [--object-lights] [--deferred]"
+                 " [--no-program-cache] [--serial-shaders] [--no-uniform-shadow] [--no-spirv]"
+                 " [--no-shadows] [--cascades N] [--shadow-resolution N] [--cached-cascades N]"
+                 " [--shadow-interval N] [--shadow-budget MS] [--no-spot-shadows] [--no-static-cache]"
+                 " [--no-lightmap] [--no-probes]" << std::endl;
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--mock-gl")
+        {
+            options.mockGl = true;
+            continue;
+        }
+        if (arg == "--keep-geometry")
+        {
+            options.keepGeometry = true;
+            continue;
+        }
+        if (arg == "--clustered")
+        {
+            options.clustered = true;
+            continue;
+        }
+        if (arg == "--heatmap")
+        {
+            options.heatmap = true;
+            continue;
+        }
+        if (arg == "--object-lights")
+        {
+            options.objectLights = true;
+            continue;
+        }
+        if (arg == "--deferred")
+        {
+            options.deferred = true;
+            continue;
+        }
+        if (arg == "--no-program-cache")
+        {
+            options.programCache = false;
+            continue;
+        }
+        if (arg == "--serial-shaders")
+        {
+            options.serialShaders = true;
+            continue;
+        }
+        if (arg == "--no-uniform-shadow")
+        {
+            options.uniformShadow = false;
+            continue;
+        }
+        if (arg == "--no-spirv")
+        {
+            options.spirv = false;
+            continue;
+        }
+        if (arg == "--no-shadows")
+        {
+            options.shadows = false;
+            continue;
+        }
+        if (arg == "--no-spot-shadows")
+        {
+            options.spotShadows = false;
+            continue;
+        }
+        if (arg == "--no-static-cache")
+        {
+            options.staticCache = false;
+            continue;
+        }
+        if (arg == "--no-lightmap")
+        {
+            options.lightmap = false;
+            continue;
+        }
+        if (arg == "--no-probes")
+        {
+            options.probes = false;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            printUsage();
+            return false;
+        }
+        const char *value = argv[++i];
+        if (arg == "--width")
+            options.width = (unsigned int)std::atoi(value);
+        else if (arg == "--height")
+            options.height = (unsigned int)std::atoi(value);
+        else if (arg == "--frames")
+            options.frames = std::atoi(value);
+        else if (arg == "--warmup")
+            options.warmup = std::atoi(value);
+        else if (arg == "--data")
+            options.dataDir = value;
+        else if (arg == "--replay")
+            options.replayPath = value;
+        else if (arg == "--timestep")
+            options.timestep = static_cast<float>(std::atof(value));
+        else if (arg == "--trace")
+            options.tracePath = value;
+        else if (arg == "--lights")
+            options.pointLights = std::atoi(value);
+        else if (arg == "--spotlights")
+            options.spotlights = std::atoi(value);
+        else if (arg == "--cascades")
+            options.cascades = std::atoi(value);
+        else if (arg == "--shadow-resolution")
+            options.shadowResolution = std::atoi(value);
+        else if (arg == "--cached-cascades")
+            options.cachedCascades = std::atoi(value);
+        else if (arg == "--shadow-interval")
+            options.shadowInterval = std::atoi(value);
+        else if (arg == "--shadow-budget")
+            options.shadowBudget = static_cast<float>(std::atof(value));
+        else
+        {
+            printUsage();
+            return false;
+        }
+    }
+    if (options.width == 0 || options.height == 0 || options.frames <= 0 || options.warmup < 0
+        || options.pointLights < 0 || options.spotlights < 0
+        || (options.cascades != -1 && (options.cascades < 1 || options.cascades > MAX_SHADOW_CASCADES))
+        || (options.shadowResolution != -1 && options.shadowResolution < 1)
+        || options.cachedCascades < -1 || (options.shadowInterval != -1 && options.shadowInterval < 1)
+        || (options.shadowBudget != -1.0f && options.shadowBudget < 0.0f))
+    {
+        printUsage();
+        return false;
+    }
+    return true;
+}
+
+// creates a surfaceless OpenGL 4.6 core context and makes it current
+static bool createHeadlessContext(EGLDisplay &display, EGLContext &context)
+{
+    // llvmpipe only advertises 4.5 although it compiles our #version 460 shaders fine;
+    // hardware drivers ignore these variables and a user-provided value always wins.
+    setenv("MESA_GL_VERSION_OVERRIDE", "4.6", 0);
+    setenv("MESA_GLSL_VERSION_OVERRIDE", "460", 0);
+
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    display = EGL_NO_DISPLAY;
+    if (getPlatformDisplay)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        std::cerr << "Failed to initialize EGL" << std::endl;
+        return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cerr << "EGL has no desktop OpenGL support" << std::endl;
+        return false;
+    }
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 6,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    // we render into our own framebuffer object, so no config or surface is needed
+    context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT)
+    {
+        std::cerr << "Failed to create an OpenGL 4.6 core context (EGL error 0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+        return false;
+    }
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        std::cerr << "Failed to make the EGL context current" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// nearest-rank percentile of an already sorted sample
+static double percentile(const std::vector<double> &sorted, double p)
+{
+    size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+    if (rank > 0)
+        rank--;
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+// s as a quoted JSON string, or null when empty
+static std::string jsonString(const std::string &s)
+{
+    if (s.empty())
+        return "null";
+    std::string out = "\"";
+    for (unsigned char c : s)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += (char)c;
+        }
+        else if (c < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        }
+        else
+            out += (char)c;
+    }
+    return out + "\"";
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    // the renderer logs to std::cout; keep stdout for the JSON report only
+    std::cout.rdbuf(std::cerr.rdbuf());
+
+    // opened before changing directory so a relative log path means what the user expects
+    InputPlayer inputPlayer;
+    inputPlayer.fixedTimestep = options.timestep;
+    if (!options.replayPath.empty() && !inputPlayer.open(options.replayPath))
+        return 1;
+    if (!options.tracePath.empty() && options.tracePath[0] != '/')
+    {
+        char cwd[4096];
+        if (getcwd(cwd, sizeof(cwd)))
+            options.tracePath = std::string(cwd) + "/" + options.tracePath;
+    }
+    if (!options.tracePath.empty() && !profiler::Profiler::enabled)
+        std::cerr << "--trace needs a build with ENABLE_PROFILER; the trace will be empty" << std::endl;
+
+    // shaders and resources are looked up relative to the working directory, like main.cpp
+    if (chdir(options.dataDir.c_str()) != 0)
+    {
+        std::cerr << "Cannot change directory to " << options.dataDir << std::endl;
+        return 1;
+    }
+
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    if (!options.mockGl && !createHeadlessContext(display, context))
+        return 1;
+
+    GLADloadproc loader = options.mockGl ? (GLADloadproc)mockgl::getProcAddress : (GLADloadproc)eglGetProcAddress;
+    if (!gladLoadGLLoader(loader))
+    {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return 1;
+    }
+    ShaderCompiler::init(loader);
+
+    // offscreen render target standing in for the window's default framebuffer
+    unsigned int fbo, colorRbo, depthRbo;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glGenRenderbuffers(1, &colorRbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorRbo);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, options.width, options.height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRbo);
+    glGenRenderbuffers(1, &depthRbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRbo);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, options.width, options.height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRbo);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "Offscreen framebuffer is incomplete" << std::endl;
+        return 1;
+    }
+    glViewport(0, 0, options.width, options.height);
+
+    ProgramCache::enabled() = options.programCache;
+    ShaderCompiler::deferred() = !options.serialShaders;
+    Shader::shadowUniforms() = options.uniformShadow;
+#ifdef SPIRV_SHADER_DIR
+    if (options.spirv)
+        Shader::spirvDirectory() = SPIRV_SHADER_DIR;
+#endif
+
+    // load: shaders, textures and models, finished on the GPU
+    auto loadStart = std::chrono::steady_clock::now();
+    Scene *scene;
+    {
+        PROFILE_ZONE("Load");
+        scene = new Scene(options.keepGeometry);
+        scene->addStressLights(options.pointLights, options.spotlights);
+        scene->clustered = options.clustered;
+        scene->clusterHeatmap = options.heatmap;
+        scene->perObjectLights = options.objectLights;
+        scene->renderPath = options.deferred ? DEFERRED_SHADING : FORWARD_SHADING;
+        scene->shadows.enabled = options.shadows;
+        if (options.cascades != -1)
+            scene->shadows.cascadeCount = options.cascades;
+        if (options.shadowResolution != -1)
+            scene->shadows.resolution = options.shadowResolution;
+        if (options.cachedCascades != -1)
+            scene->shadows.cachedCascades = options.cachedCascades;
+        if (options.shadowInterval != -1)
+            scene->shadows.cacheInterval = options.shadowInterval;
+        if (options.shadowBudget != -1.0f)
+            scene->shadows.budgetMs = options.shadowBudget;
+        scene->spotShadows.enabled = options.spotShadows;
+        scene->spotShadows.cacheStatic = options.staticCache;
+        scene->useLightmap = options.lightmap;
+        scene->useProbes = options.probes;
+        glFinish();
+    }
+    double loadMs = millisecondsSince(loadStart);
+
+    float aspect = (float)options.width / (float)options.height;
+    std::vector<double> frameMs;
+    frameMs.reserve(options.frames);
+
+    // warm-up frames render the initial state and do not consume the replay
+    for (int frame = 0; frame < options.warmup; frame++)
+    {
+        scene->render(0.0, aspect);
+        glFinish();
+    }
+
+    // GPU times of the warm-up frames are not part of the report
+    scene->gpuTimer.flush();
+    scene->gpuTimer.resetTotals();
+
+    // GL calls summed over the measured frames (mock GL only)
+    mockgl::Counters callTotals;
+    Shader::uniformStats() = Shader::UniformStats();
+    long renderedCascades = 0;
+    long deferredCascades = 0;
+    long staticSpotRenders = 0;
+
+    double sceneTime = 0.0;
+    for (int frame = 0; frame < options.frames; frame++)
+    {
+        PROFILE_ZONE("Frame");
+        auto frameStart = std::chrono::steady_clock::now();
+        mockgl::counters().reset();
+
+        FrameInput input;
+        input.deltaTime = SIM_TIMESTEP;
+        if (inputPlayer.isOpen() && !inputPlayer.next(input))
+            break;
+        applyInput(*scene, input);
+        sceneTime += input.deltaTime;
+
+        scene->render(sceneTime, aspect);
+        renderedCascades += scene->shadows.renderedCascades;
+        deferredCascades += scene->shadows.deferredCascades;
+        staticSpotRenders += scene->spotShadows.staticRenders;
+        // there is no swap to throttle on, so wait for the GPU to include its work in the frame time
+        {
+            PROFILE_ZONE("glFinish");
+            glFinish();
+        }
+        frameMs.push_back(millisecondsSince(frameStart));
+
+        const mockgl::Counters &calls = mockgl::counters();
+        callTotals.drawCalls += calls.drawCalls;
+        callTotals.uniformUploads += calls.uniformUploads;
+        callTotals.uniformLookups += calls.uniformLookups;
+        callTotals.textureBinds += calls.textureBinds;
+        callTotals.bufferUploads += calls.bufferUploads;
+        callTotals.bufferUploadBytes += calls.bufferUploadBytes;
+        callTotals.textureUploads += calls.textureUploads;
+        callTotals.programBinds += calls.programBinds;
+    }
+    if (frameMs.empty())
+    {
+        std::cerr << "The replay contains no frames" << std::endl;
+        return 1;
+    }
+
+    scene->gpuTimer.flush();
+
+    std::vector<double> sorted = frameMs;
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (double ms : frameMs)
+        sum += ms;
+
+    std::printf("{\n");
+    std::printf("  \"renderer\": %s,\n", jsonString((const char *)glGetString(GL_RENDERER)).c_str());
+    std::printf("  \"version\": %s,\n", jsonString((const char *)glGetString(GL_VERSION)).c_str());
+    std::printf("  \"width\": %u,\n", options.width);
+    std::printf("  \"height\": %u,\n", options.height);
+    std::printf("  \"warmup\": %d,\n", options.warmup);
+    std::printf("  \"frames\": %d,\n", (int)frameMs.size());
+    std::printf("  \"replay\": %s,\n", jsonString(options.replayPath).c_str());
+    std::printf("  \"load_ms\": %.3f,\n", loadMs);
+    const ProgramCache::Stats &cacheStats = ProgramCache::stats();
+    std::printf("  \"program_cache\": { \"enabled\": %s, \"hits\": %u, \"misses\": %u, \"rejected\": %u },\n",
+        options.programCache ? "true" : "false", cacheStats.hits, cacheStats.misses, cacheStats.rejected);
+    // submit_ms + wait_ms is the time shader compilation kept the load waiting
+    const ShaderCompiler::Stats &compileStats = ShaderCompiler::stats();
+    std::printf("  \"shaders\": { \"parallel\": %s, \"compiler_threads\": %d, \"deferred\": %s, \"programs\": %u, \"submit_ms\": %.3f, \"wait_ms\": %.3f, \"files_read\": %u, \"spirv\": %s, \"spirv_programs\": %u },\n",
+        ShaderCompiler::parallel() ? "true" : "false", ShaderCompiler::maxCompilerThreads(),
+        options.serialShaders ? "false" : "true", compileStats.programs, compileStats.submitMs, compileStats.waitMs, compileStats.filesRead,
+        Shader::spirvDirectory().empty() || !ShaderCompiler::spirv() ? "false" : "true", compileStats.spirvPrograms);
+    const Shader::UniformStats &uniformStats = Shader::uniformStats();
+    std::printf("  \"uniforms\": { \"shadow\": %s, \"issued_per_frame\": %.1f, \"skipped_per_frame\": %.1f },\n",
+        options.uniformShadow ? "true" : "false", uniformStats.issued / (double)frameMs.size(), uniformStats.skipped / (double)frameMs.size());
+    // the lists of the last frame
+    const ObjectLights &objectLights = scene->objectLights;
+    bool perObject = (scene->litFeatures() & FEATURE_OBJECT_LIGHTS) != 0;
+    std::printf("  \"lights\": { \"point\": %d, \"spot\": %d, \"clustered\": %s, \"object_lights\": %s, \"draws\": %d, \"lights_per_draw\": %.2f },\n",
+        scene->lights.pointLightCount(), scene->lights.spotlightCount(), options.clustered ? "true" : "false",
+        perObject ? "true" : "false", perObject ? objectLights.draws : 0,
+        perObject && objectLights.draws > 0 ? objectLights.assignedLights / (double)objectLights.draws : 0.0);
+    std::printf("  \"render_path\": \"%s\",\n", options.deferred ? "deferred" : "forward");
+    // the settings after ShadowCascades clamped them
+    const ShadowCascades &shadows = scene->shadows;
+    std::printf("  \"shadows\": { \"enabled\": %s, \"cascades\": %d, \"resolution\": %d, \"cached_cascades\": %d, \"interval\": %d, \"budget_ms\": %.2f, \"rendered_per_frame\": %.2f, \"deferred_per_frame\": %.2f, \"gpu_bytes\": %zu },\n",
+        shadows.enabled ? "true" : "false", shadows.cascadeCount, shadows.resolution, shadows.cachedCascades,
+        shadows.cacheInterval, shadows.budgetMs, renderedCascades / (double)frameMs.size(),
+        deferredCascades / (double)frameMs.size(), shadows.gpuBytes());
+    const SpotShadows &spotShadows = scene->spotShadows;
+    std::printf("  \"spot_shadows\": { \"enabled\": %s, \"static_cache\": %s, \"resolution\": %d, \"static_renders_per_frame\": %.2f, \"gpu_bytes\": %zu },\n",
+        spotShadows.enabled ? "true" : "false", spotShadows.cacheStatic ? "true" : "false", spotShadows.resolution,
+        staticSpotRenders / (double)frameMs.size(), spotShadows.gpuBytes());
+    const Lightmap &lightmap = scene->dust2Lightmap;
+    std::printf("  \"lightmap\": { \"loaded\": %s, \"used\": %s, \"baked_point_lights\": %d, \"gpu_bytes\": %zu },\n",
+        lightmap.loaded() ? "true" : "false", lightmap.loaded() && options.lightmap && !options.deferred ? "true" : "false",
+        lightmap.bakedPointLights, lightmap.gpuBytes());
+    const IrradianceProbes &probes = scene->dust2Probes;
+    std::printf("  \"probes\": { \"loaded\": %s, \"used\": %s, \"count\": %zu, \"gpu_bytes\": %zu },\n",
+        probes.loaded() ? "true" : "false", probes.loaded() && options.probes && !options.deferred ? "true" : "false",
+        probes.probeCount(), probes.gpuBytes());
+    std::printf("  \"models\": {\n");
+    std::printf("    \"bmw_g82_m4\": %s,\n", scene->bmw_g82_m4_model.loadStats.toJson().c_str());
+    std::printf("    \"de_dust2\": %s\n", scene->de_dust2_model.loadStats.toJson().c_str());
+    std::printf("  },\n");
+    MemoryUsage bmwMemory = scene->bmw_g82_m4_model.memoryUsage();
+    MemoryUsage dust2Memory = scene->de_dust2_model.memoryUsage();
+    std::printf("  \"memory\": {\n");
+    std::printf("    \"bmw_g82_m4\": { \"cpu_bytes\": %zu, \"gpu_bytes\": %zu },\n", bmwMemory.cpuBytes, bmwMemory.gpuBytes);
+    std::printf("    \"de_dust2\": { \"cpu_bytes\": %zu, \"gpu_bytes\": %zu }\n", dust2Memory.cpuBytes, dust2Memory.gpuBytes);
+    std::printf("  },\n");
+    std::printf("  \"frame_ms\": {\n");
+    std::printf("    \"mean\": %.3f,\n", sum / frameMs.size());
+    std::printf("    \"p50\": %.3f,\n", percentile(sorted, 50.0));
+    std::printf("    \"p95\": %.3f,\n", percentile(sorted, 95.0));
+    std::printf("    \"p99\": %.3f,\n", percentile(sorted, 99.0));
+    std::printf("    \"min\": %.3f,\n", sorted.front());
+    std::printf("    \"max\": %.3f\n", sorted.back());
+    std::printf("  },\n");
+    // per pass: mean over the measured frames and the rolling average of the last frames
+    std::printf("  \"gpu_ms\": {");
+    bool firstPass = true;
+    for (const GpuTimer::Pass &pass : scene->gpuTimer.passes)
+    {
+        if (pass.totalSamples == 0)
+            continue;
+        std::printf("%s\n    \"%s\": { \"mean\": %.3f, \"rolling\": %.3f }",
+            firstPass ? "" : ",", pass.name.c_str(), pass.meanMs(), pass.averageMs());
+        firstPass = false;
+    }
+    std::printf("\n  }");
+    if (options.mockGl)
+    {
+        double frames = (double)frameMs.size();
+        std::printf(",\n  \"gl_calls_per_frame\": {\n");
+        std::printf("    \"draw_calls\": %.1f,\n", callTotals.drawCalls / frames);
+        std::printf("    \"uniform_uploads\": %.1f,\n", callTotals.uniformUploads / frames);
+        std::printf("    \"uniform_lookups\": %.1f,\n", callTotals.uniformLookups / frames);
+        std::printf("    \"texture_binds\": %.1f,\n", callTotals.textureBinds / frames);
+        std::printf("    \"buffer_uploads\": %.1f,\n", callTotals.bufferUploads / frames);
+        std::printf("    \"buffer_upload_bytes\": %.1f,\n", callTotals.bufferUploadBytes / frames);
+        std::printf("    \"texture_uploads\": %.1f,\n", callTotals.textureUploads / frames);
+        std::printf("    \"program_binds\": %.1f\n", callTotals.programBinds / frames);
+        std::printf("  }");
+    }
+    std::printf("\n}\n");
+
+    // every frame sets model matrices: no uploads means the setters lost their locations (the
+    // mock has no uniform introspection) and the counts above measure nothing
+    bool uniformsLost = options.mockGl && callTotals.uniformUploads == 0;
+    if (uniformsLost)
+        std::cerr << "ERROR::BENCH::NO_UNIFORM_UPLOADS: the mock GL counted no uniform uploads" << std::endl;
+
+    if (!options.tracePath.empty())
+        profiler::Profiler::writeChromeTrace(options.tracePath);
+
+    delete scene;
+    glDeleteRenderbuffers(1, &colorRbo);
+    glDeleteRenderbuffers(1, &depthRbo);
+    glDeleteFramebuffers(1, &fbo);
+
+    if (display != EGL_NO_DISPLAY)
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+    }
+    return uniformsLost ? 1 : 0;
+}
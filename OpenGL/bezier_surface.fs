@@ -1,197 +1,37 @@
 #version 460 core
 
-in PVA
+layout (location = 0) in PVA
 {
 	vec3 ecPosition;
 	vec3 ecUnitNormal;
 } pvaIn;
 
-in vec3 fragPos;
+layout (location = 2) in vec3 fragPos;
 
-out vec4 FragColor;
+layout (location = 0) out vec4 FragColor;
 
-uniform vec3 material_diffuse;
-uniform vec3 material_specular;
-uniform float shininess;
+#ifdef TEXTURED
+layout (location = 3) in vec2 TexCoords;
+layout (location = 2) uniform sampler2D texture_diffuse1;
+layout (location = 3) uniform sampler2D texture_specular1;
+#else
+layout (location = 4) uniform vec3 material_diffuse;
+layout (location = 5) uniform vec3 material_specular;
+#endif
+layout (location = 1) uniform float shininess;
 
-struct DirLight {
-    vec3 direction;
-	
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-struct PointLight {
-    vec3 position;
-    
-    float constant;
-    float linear;
-    float quadratic;
-	
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-struct SpotLight {
-    vec3 position;
-    vec3 direction;
-    float cutOff;
-    float outerCutOff;
-  
-    float constant;
-    float linear;
-    float quadratic;
-  
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;       
-};
-
-
-
-#define NR_POINT_LIGHTS 2
-#define NR_SPOTLIGHTS 2
-
-uniform vec3 viewPos;
-uniform DirLight dirLight;
-uniform PointLight pointLights[NR_POINT_LIGHTS];
-uniform SpotLight spotLights[NR_SPOTLIGHTS];
-uniform vec3 fogColor;
-uniform float fogIntensity;
-uniform bool blinn;
-
-// function prototypes
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-float CalcFogFactor(vec3 worldPos);
+#include "lighting.glsl"
 
 void main()
-{    
-
-    // properties
-    vec3 norm = normalize(pvaIn.ecUnitNormal);
-    vec3 FragPos = fragPos;
-    vec3 viewDir = normalize(viewPos - FragPos);
-    
-    // == =====================================================
-    // Our lighting is set up in 3 phases: directional, point lights and an optional flashlight
-    // For each phase, a calculate function is defined that calculates the corresponding color
-    // per lamp. In the main() function we take all the calculated colors and sum them up for
-    // this fragment's final color.
-    // == =====================================================
-    // phase 1: directional lighting
-    vec3 result = CalcDirLight(dirLight, norm, viewDir);
-    // phase 2: point lights
-    for(int i = 0; i < NR_POINT_LIGHTS; i++)
-        result += CalcPointLight(pointLights[i], norm, FragPos, viewDir);    
-    // phase 3: spot light
-    for(int i = 0; i < NR_SPOTLIGHTS; i++)
-        result += CalcSpotLight(spotLights[i], norm, FragPos, viewDir);    
-    
-    float fog_factor = CalcFogFactor(FragPos);
-    result = mix(fogColor, result, fog_factor);
-
-    FragColor = vec4(result, 1.0);
-}
-
-// calculates the color when using a directional light.
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
 {
-    vec3 lightDir = normalize(-light.direction);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = 0.0;
-    if (blinn)
-    {
-        spec = pow(max(dot(normal, normalize(lightDir + viewDir)), 0.0), shininess);
-    }
-    else
-    {
-        spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
-    }
-    // combine results
-    vec3 ambient = light.ambient * material_diffuse;
-    vec3 diffuse = light.diffuse * diff * material_diffuse;
-    vec3 specular = light.specular * spec;
-    return (ambient + diffuse + specular);
+    // a white specular for the sun and the lamps; the material's specular only for the headlights
+#ifdef TEXTURED
+    Material material = MakeMaterial(vec3(texture(texture_diffuse1, TexCoords)), vec3(1.0), shininess);
+    material.spotSpecular = vec3(texture(texture_specular1, TexCoords));
+#else
+    Material material = MakeMaterial(material_diffuse, vec3(1.0), shininess);
+    material.spotSpecular = material_specular;
+#endif
+    vec3 normal = normalize(pvaIn.ecUnitNormal);
+    FragColor = vec4(ShadeForward(material, normal, fragPos, ProbeLight(fragPos, normal)), 1.0);
 }
-
-// calculates the color when using a point light.
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
-{
-    vec3 lightDir = normalize(light.position - fragPos);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = 0.0;
-    if (blinn)
-    {
-        spec = pow(max(dot(normal, normalize(lightDir + viewDir)), 0.0), shininess);
-    }
-    else
-    {
-        spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
-    }
-    // attenuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
-    // combine results
-    vec3 ambient = light.ambient * material_diffuse;
-    vec3 diffuse = light.diffuse * diff * material_diffuse;
-    vec3 specular = light.specular * spec;
-    ambient *= attenuation;
-    diffuse *= attenuation;
-    specular *= attenuation;
-    return (ambient + diffuse + specular);
-}
-
-// calculates the color when using a spot light.
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
-{
-    vec3 lightDir = normalize(light.position - fragPos);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = 0.0;
-    if (blinn)
-    {
-        spec = pow(max(dot(normal, normalize(lightDir + viewDir)), 0.0), shininess);
-    }
-    else
-    {
-        spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
-    }
-    // attenuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
-    // spotlight intensity
-    float theta = dot(lightDir, normalize(-light.direction)); 
-    //float epsilon = light.cutOff - light.outerCutOff;
-    //float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
-    float intensity = pow(max(theta, 0.0), 32);
-    // combine results
-    vec3 ambient = light.ambient * material_diffuse;
-    vec3 diffuse = light.diffuse * diff * material_diffuse;
-    vec3 specular = light.specular * spec * material_specular;
-    ambient *= attenuation * intensity;
-    diffuse *= attenuation * intensity;
-    specular *= attenuation * intensity;
-    return (ambient + diffuse + specular);
-}
-
-float CalcFogFactor(vec3 fragPos)
-{
-    if (fogIntensity == 0) return 1;
-    float gradient = (fogIntensity * fogIntensity - 50 * fogIntensity + 60);
-    float distance = length(viewPos - fragPos);
-    float fog = exp(-pow((distance / gradient), 4));
-    fog = clamp(fog, 0.0, 1.0);
-    return fog;
-}
\ No newline at end of file
@@ -6,7 +6,7 @@ layout (location = 0) in vec3 aPos;
 // texture coordinate
 layout (location = 1) in vec2 aTex;
 
-out vec2 TexCoord;
+layout (location = 0) out vec2 TexCoord;
 
 void main()
 {
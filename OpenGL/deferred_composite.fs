@@ -0,0 +1,34 @@
+#version 460 core
+// Last pass of the deferred renderer: fogs the accumulated light like the forward shaders and
+// writes it over the sky-coloured target, with the depth the surface would have had there.
+layout (location = 0) out vec4 FragColor;
+
+layout (location = 8) uniform sampler2D lightAccumulation;
+layout (location = 5) uniform sampler2D gDepth;
+
+layout (location = 6) uniform mat4 inverseProjection;
+
+#include "scene_blocks.glsl"
+#include "fog.glsl"
+#include "features.glsl"
+
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / screenSize;
+    float depth = texture(gDepth, uv).r;
+    if (depth == 0.0)
+        discard;
+
+    // distance to the camera, as length(viewPos - FragPos) in the forward shaders
+    vec4 ray = inverseProjection * vec4(uv * 2.0 - 1.0, -1.0, 1.0);
+    vec3 viewRay = ray.xyz / ray.w;
+    vec3 viewPosition = viewRay * (depth / -viewRay.z);
+    float distance = length(viewPosition);
+    vec4 clip = projection * vec4(viewPosition, 1.0);
+    gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;
+
+    vec3 result = texture(lightAccumulation, uv).rgb;
+    if (FOG_ENABLED)
+        result = mix(fogColor, result, CalcFogFactor(distance));
+    FragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,66 @@
+#version 460 core
+// Adds one light to the accumulation buffer of the deferred renderer, using the surface
+// attributes of the G-buffer (see gbuffer.fs). The lighting is the one of the forward shaders
+// (lighting.glsl).
+layout (location = 0) out vec4 FragColor;
+
+layout (location = 0) flat in int lightIndex;
+
+layout (location = 2) uniform sampler2D gAlbedo;
+layout (location = 3) uniform sampler2D gSpecular;
+layout (location = 4) uniform sampler2D gNormal;
+layout (location = 5) uniform sampler2D gDepth;
+
+layout (location = 0) uniform int lightType;
+layout (location = 6) uniform mat4 inverseProjection;
+layout (location = 7) uniform mat4 inverseView;
+
+#include "lighting.glsl"
+
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / screenSize;
+    float depth = texture(gDepth, uv).r;
+    // sky
+    if (depth == 0.0)
+        discard;
+
+    vec4 albedoShininess = texture(gAlbedo, uv);
+    vec4 specularSpot = texture(gSpecular, uv);
+    vec4 normalScale = texture(gNormal, uv);
+    Material material;
+    material.diffuse = albedoShininess.rgb;
+    // the flag's specular colour only applies to the headlights, on top of a white one
+    vec3 specular = specularSpot.rgb * 2.0;
+    material.specular = mix(vec3(1.0), specular, specularSpot.a);
+    material.spotSpecular = mix(specular, vec3(1.0), specularSpot.a);
+    material.pointDiffuseScale = normalScale.w;
+    material.shininess = albedoShininess.a * 255.0;
+    vec3 normal = normalize(normalScale.xyz);
+
+    // world position from the view-space distance
+    vec4 ray = inverseProjection * vec4(uv * 2.0 - 1.0, -1.0, 1.0);
+    vec3 viewRay = ray.xyz / ray.w;
+    vec3 fragPos = vec3(inverseView * vec4(viewRay * (depth / -viewRay.z), 1.0));
+    vec3 viewDir = normalize(viewPos - fragPos);
+
+    vec3 result;
+    if (lightType == 0)
+        result = CalcDirLight(dirLight, material, normal, viewDir, CalcSunShadow(fragPos, normal));
+    else if (lightType == 1)
+    {
+        PointLight light = pointLights[lightIndex];
+        // the volume also covers pixels in front of the sphere
+        if (length(light.position - fragPos) > light.radius)
+            discard;
+        result = CalcPointLight(light, material, normal, fragPos, viewDir);
+    }
+    else
+    {
+        SpotLight light = spotLights[lightIndex];
+        if (length(light.position - fragPos) > light.radius)
+            discard;
+        result = CalcSpotLight(light, material, normal, fragPos, viewDir);
+    }
+    FragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,28 @@
+#version 460 core
+// Light passes of the deferred renderer (see deferred_renderer.h).
+// lightType 0: a full-screen triangle for the sun/moon and the fog composite, no vertex input.
+// lightType 1 / 2: one instance of the unit sphere per point light / spotlight, scaled to the
+// light's range, so only the pixels the light can reach are shaded.
+layout (location = 0) in vec3 aPos;
+
+#include "scene_blocks.glsl"
+
+layout (location = 0) uniform int lightType;
+// the sphere mesh is inscribed in the unit sphere; this pushes its faces out to radius 1
+layout (location = 1) uniform float volumeScale;
+
+layout (location = 0) flat out int lightIndex;
+
+void main()
+{
+    lightIndex = gl_InstanceID;
+    if (lightType == 0)
+    {
+        vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+        gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+        return;
+    }
+    vec3 center = lightType == 1 ? pointLights[gl_InstanceID].position : spotLights[gl_InstanceID].position;
+    float radius = lightType == 1 ? pointLights[gl_InstanceID].radius : spotLights[gl_InstanceID].radius;
+    gl_Position = projection * view * vec4(center + aPos * radius * volumeScale, 1.0);
+}
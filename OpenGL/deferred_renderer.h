@@ -0,0 +1,296 @@
+#ifndef DEFERRED_RENDERER_H
+#define DEFERRED_RENDERER_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/shader_t.h>
+#include <learnopengl/shader_variants.h>
+
+#include "shader_features.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// Deferred shading, the alternative to the forward shaders (Scene::renderPath).
+// 1. beginGeometry(): the objects are drawn with gbuffer.fs / gbuffer_flag.fs into a G-buffer
+//    holding albedo, specular, normal and view depth, so lighting runs once per pixel whatever
+//    the overdraw.
+// 2. accumulateLights(): the sun/moon is a full-screen pass; every point light and spotlight is
+//    an instanced sphere scaled to the light's range. Only its back faces are drawn, with the
+//    depth test reversed, so a light shades exactly the pixels whose surface lies in front of the
+//    far side of its volume. That holds with the camera inside the volume too. Results add up
+//    in a half-float accumulation buffer.
+// 3. composite(): fog is applied to the accumulated light and written to the target
+//    framebuffer, together with the depth of the G-buffer's surfaces, so forward-drawn objects
+//    (the light cubes) are still occluded. The G-buffer's own depth has no stencil: the light
+//    volumes do without one.
+class DeferredRenderer
+{
+public:
+    DeferredRenderer()
+        // Phong, the scene's default
+        : lightShader(SHADER_FEATURES, 0, "deferred_light.vs", "deferred_light.fs"),
+          // with fog, the scene's default
+          compositeShader(SHADER_FEATURES, FEATURE_FOG, "deferred_light.vs", "deferred_composite.fs"),
+          width(0), height(0), gBuffer(0), accumulationBuffer(0)
+    {
+        lightShader.onCreate([](Shader &shader) {
+            shader.setInt("gAlbedo", 0);
+            shader.setInt("gSpecular", 1);
+            shader.setInt("gNormal", 2);
+            shader.setInt("gDepth", 3);
+            shader.setFloat("volumeScale", volumeScale());
+        });
+
+        compositeShader.onCreate([](Shader &shader) {
+            shader.setInt("lightAccumulation", 0);
+            shader.setInt("gDepth", 3);
+        });
+
+        buildSphere();
+        // the full-screen triangle is generated from gl_VertexID but a VAO must be bound
+        glGenVertexArrays(1, &emptyVAO);
+    }
+
+    ~DeferredRenderer()
+    {
+        releaseTargets();
+        glDeleteVertexArrays(1, &sphereVAO);
+        glDeleteBuffers(1, &sphereVBO);
+        glDeleteBuffers(1, &sphereEBO);
+        glDeleteVertexArrays(1, &emptyVAO);
+    }
+
+    DeferredRenderer(const DeferredRenderer &) = delete;
+    DeferredRenderer &operator=(const DeferredRenderer &) = delete;
+
+    // binds and clears the G-buffer, (re)creating it when the viewport size changed
+    void beginGeometry(int viewportWidth, int viewportHeight)
+    {
+        if (viewportWidth != width || viewportHeight != height)
+            createTargets(viewportWidth, viewportHeight);
+        glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+        // depth 0 marks pixels without geometry
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    // the Camera and Lighting blocks and the light buffers must be uploaded for this frame;
+    // of the shader_feature bits only FEATURE_BLINN applies to the light passes
+    void accumulateLights(const glm::mat4 &projection, const glm::mat4 &view, int pointLightCount, int spotlightCount,
+                          unsigned int features)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, accumulationBuffer);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        bindGBufferTextures();
+        Shader &shader = lightShader.get(features & FEATURE_BLINN);
+        shader.use();
+        shader.setMat4("inverseProjection", glm::inverse(projection));
+        shader.setMat4("inverseView", glm::inverse(view));
+        Shader::Uniform lightTypeUniform = shader.uniform("lightType");
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+        glDepthMask(GL_FALSE);
+
+        // sun / moon over every pixel
+        glDisable(GL_DEPTH_TEST);
+        shader.setInt(lightTypeUniform, 0);
+        glBindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        // light volumes: back faces behind or at the surface
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_GEQUAL);
+        glEnable(GL_CULL_FACE);
+        glCullFace(GL_FRONT);
+        glBindVertexArray(sphereVAO);
+        if (pointLightCount > 0)
+        {
+            shader.setInt(lightTypeUniform, 1);
+            glDrawElementsInstanced(GL_TRIANGLES, sphereIndexCount, GL_UNSIGNED_INT, 0, pointLightCount);
+        }
+        if (spotlightCount > 0)
+        {
+            shader.setInt(lightTypeUniform, 2);
+            glDrawElementsInstanced(GL_TRIANGLES, sphereIndexCount, GL_UNSIGNED_INT, 0, spotlightCount);
+        }
+
+        glCullFace(GL_BACK);
+        glDisable(GL_CULL_FACE);
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+        glDisable(GL_BLEND);
+        glBindVertexArray(0);
+    }
+
+    // writes the fogged result over the already cleared target framebuffer; of the
+    // shader_feature bits only FEATURE_FOG applies
+    void composite(GLuint targetFramebuffer, const glm::mat4 &projection, unsigned int features)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, accumulationTexture);
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_2D, depthTexture);
+        glActiveTexture(GL_TEXTURE0);
+
+        Shader &shader = compositeShader.get(features & FEATURE_FOG);
+        shader.use();
+        shader.setMat4("inverseProjection", glm::inverse(projection));
+        // the shader writes the depth of every covered pixel, whatever the target's depth format
+        glDepthFunc(GL_ALWAYS);
+        glBindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glDepthFunc(GL_LESS);
+    }
+
+    size_t gpuBytes() const
+    {
+        // albedo, specular, normal, view depth, depth, accumulation
+        return (size_t)width * height * (4 + 4 + 8 + 4 + 4 + 8);
+    }
+
+private:
+    // one variant per shading model, and with and without fog
+    ShaderVariants lightShader;
+    ShaderVariants compositeShader;
+
+    int width, height;
+    GLuint gBuffer, accumulationBuffer;
+    GLuint albedoTexture, specularTexture, normalTexture, depthTexture, accumulationTexture;
+    GLuint depthRbo;
+
+    static const int SPHERE_SLICES = 16;
+    static const int SPHERE_STACKS = 8;
+    GLuint sphereVAO, sphereVBO, sphereEBO;
+    GLsizei sphereIndexCount;
+    GLuint emptyVAO;
+
+    // the faces of the sphere mesh are at least cos(half a slice) * cos(half a stack) from its
+    // centre; scaling by the inverse makes the mesh enclose the unit sphere
+    static float volumeScale()
+    {
+        const float pi = 3.14159265f;
+        return 1.0f / (std::cos(pi / SPHERE_SLICES) * std::cos(pi / (2 * SPHERE_STACKS)));
+    }
+
+    void buildSphere()
+    {
+        const float pi = 3.14159265f;
+        std::vector<glm::vec3> vertices;
+        for (int stack = 0; stack <= SPHERE_STACKS; stack++)
+        {
+            float phi = pi * stack / SPHERE_STACKS;
+            for (int slice = 0; slice <= SPHERE_SLICES; slice++)
+            {
+                float theta = 2.0f * pi * slice / SPHERE_SLICES;
+                vertices.push_back(glm::vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta)));
+            }
+        }
+        // counter-clockwise seen from outside, so culling front faces keeps the far side
+        std::vector<unsigned int> indices;
+        for (int stack = 0; stack < SPHERE_STACKS; stack++)
+        {
+            for (int slice = 0; slice < SPHERE_SLICES; slice++)
+            {
+                unsigned int first = stack * (SPHERE_SLICES + 1) + slice;
+                unsigned int below = first + SPHERE_SLICES + 1;
+                indices.insert(indices.end(), { first, first + 1, below, below, first + 1, below + 1 });
+            }
+        }
+        sphereIndexCount = (GLsizei)indices.size();
+
+        glGenVertexArrays(1, &sphereVAO);
+        glGenBuffers(1, &sphereVBO);
+        glGenBuffers(1, &sphereEBO);
+        glBindVertexArray(sphereVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *)0);
+        glBindVertexArray(0);
+    }
+
+    static GLuint createTexture(int w, int h, GLenum internalFormat, GLenum format, GLenum type)
+    {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        return texture;
+    }
+
+    void createTargets(int w, int h)
+    {
+        releaseTargets();
+        width = w;
+        height = h;
+
+        albedoTexture = createTexture(w, h, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+        specularTexture = createTexture(w, h, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+        normalTexture = createTexture(w, h, GL_RGBA16F, GL_RGBA, GL_FLOAT);
+        depthTexture = createTexture(w, h, GL_R32F, GL_RED, GL_FLOAT);
+        accumulationTexture = createTexture(w, h, GL_RGBA16F, GL_RGBA, GL_FLOAT);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenRenderbuffers(1, &depthRbo);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthRbo);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+
+        glGenFramebuffers(1, &gBuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedoTexture, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, specularTexture, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, normalTexture, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT3, GL_TEXTURE_2D, depthTexture, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRbo);
+        const GLenum gBufferAttachments[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3 };
+        glDrawBuffers(4, gBufferAttachments);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::DEFERRED::G_BUFFER_INCOMPLETE" << std::endl;
+
+        // shares the G-buffer depth for the light volume depth test
+        glGenFramebuffers(1, &accumulationBuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, accumulationBuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accumulationTexture, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRbo);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::DEFERRED::ACCUMULATION_BUFFER_INCOMPLETE" << std::endl;
+    }
+
+    void releaseTargets()
+    {
+        if (gBuffer == 0)
+            return;
+        glDeleteFramebuffers(1, &gBuffer);
+        glDeleteFramebuffers(1, &accumulationBuffer);
+        GLuint textures[] = { albedoTexture, specularTexture, normalTexture, depthTexture, accumulationTexture };
+        glDeleteTextures(5, textures);
+        glDeleteRenderbuffers(1, &depthRbo);
+        gBuffer = accumulationBuffer = 0;
+    }
+
+    void bindGBufferTextures()
+    {
+        const GLuint textures[] = { albedoTexture, specularTexture, normalTexture, depthTexture };
+        for (int i = 0; i < 4; i++)
+        {
+            glActiveTexture(GL_TEXTURE0 + i);
+            glBindTexture(GL_TEXTURE_2D, textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+};
+
+#endif
@@ -0,0 +1,19 @@
+// Feature switches of the variant system (shader_features.h). From GLSL they are the #defines of
+// the variant; a SPIR-V module (GL_SPIRV) takes them as specialization constants instead, set when
+// the program is loaded, so one module serves every combination. Shader reads the constant_id
+// of each NAME_ENABLED declared here to specialize the feature NAME.
+#ifdef GL_SPIRV
+layout (constant_id = 0) const bool BLINN_ENABLED = false;
+layout (constant_id = 1) const bool FOG_ENABLED = false;
+#else
+#ifdef BLINN
+const bool BLINN_ENABLED = true;
+#else
+const bool BLINN_ENABLED = false;
+#endif
+#ifdef FOG
+const bool FOG_ENABLED = true;
+#else
+const bool FOG_ENABLED = false;
+#endif
+#endif
@@ -0,0 +1,9 @@
+// Distance fog of the scene: 1 keeps the lit colour, 0 is fully fogColor. Only called by
+// FOG_ENABLED variants, so fogIntensity is never 0 here.
+float CalcFogFactor(float distance)
+{
+    float gradient = (fogIntensity * fogIntensity - 50 * fogIntensity + 60);
+    float fog = exp(-pow((distance / gradient), 4));
+    fog = clamp(fog, 0.0, 1.0);
+    return fog;
+}
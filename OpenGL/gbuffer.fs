@@ -0,0 +1,37 @@
+#version 460 core
+// G-buffer pass of the deferred renderer (see deferred_renderer.h) for the textured objects:
+// writes the surface attributes the lighting passes need instead of lighting the fragment.
+layout (location = 0) out vec4 gAlbedo;   // rgb: diffuse colour, a: shininess / 255
+layout (location = 1) out vec4 gSpecular; // rgb: specular colour / 2, a: 1 for every light, 0 for
+                                          // the headlights only (white for the others)
+layout (location = 2) out vec4 gNormal;   // xyz: world normal, w: point light diffuse scale
+layout (location = 3) out float gDepth;   // view-space distance along -z, 0 where nothing was drawn
+
+layout (location = 0) in vec3 FragPos;
+layout (location = 1) in vec3 Normal;
+layout (location = 2) in vec2 TexCoords;
+
+layout (location = 2) uniform sampler2D texture_diffuse1;
+layout (location = 3) uniform sampler2D texture_specular1;
+layout (location = 1) uniform float shininess;
+
+// per-object differences of the forward shaders
+layout (location = 8) uniform bool specularTexture;    // false: white specular (car_shader.fs)
+layout (location = 9) uniform float specularScale;     // 2 in 6.multiple_lights.fs
+layout (location = 10) uniform float pointDiffuseScale; // 1, or CAR_POINT_DIFFUSE_SCALE in scene.h for the car
+
+layout (std140, binding = 0) uniform Camera
+{
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
+
+void main()
+{
+    vec3 specular = specularTexture ? vec3(texture(texture_specular1, TexCoords)) : vec3(1.0);
+    gAlbedo = vec4(vec3(texture(texture_diffuse1, TexCoords)), shininess / 255.0);
+    gSpecular = vec4(specularScale * specular * 0.5, 1.0);
+    gNormal = vec4(normalize(Normal), pointDiffuseScale);
+    gDepth = -(view * vec4(FragPos, 1.0)).z;
+}
@@ -0,0 +1,45 @@
+#version 460 core
+// G-buffer pass of the deferred renderer for the flag (see gbuffer.fs for the layout)
+layout (location = 0) out vec4 gAlbedo;
+layout (location = 1) out vec4 gSpecular;
+layout (location = 2) out vec4 gNormal;
+layout (location = 3) out float gDepth;
+
+layout (location = 0) in PVA
+{
+	vec3 ecPosition;
+	vec3 ecUnitNormal;
+} pvaIn;
+
+layout (location = 2) in vec3 fragPos;
+
+#ifdef TEXTURED
+layout (location = 3) in vec2 TexCoords;
+layout (location = 2) uniform sampler2D texture_diffuse1;
+layout (location = 3) uniform sampler2D texture_specular1;
+#define MATERIAL_DIFFUSE vec3(texture(texture_diffuse1, TexCoords))
+#define MATERIAL_SPECULAR vec3(texture(texture_specular1, TexCoords))
+#else
+layout (location = 4) uniform vec3 material_diffuse;
+layout (location = 5) uniform vec3 material_specular;
+#define MATERIAL_DIFFUSE material_diffuse
+#define MATERIAL_SPECULAR material_specular
+#endif
+layout (location = 1) uniform float shininess;
+
+layout (std140, binding = 0) uniform Camera
+{
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
+
+void main()
+{
+    // bezier_surface.fs uses a white specular for the sun and the lamps and MATERIAL_SPECULAR
+    // for the headlights
+    gAlbedo = vec4(MATERIAL_DIFFUSE, shininess / 255.0);
+    gSpecular = vec4(MATERIAL_SPECULAR * 0.5, 0.0);
+    gNormal = vec4(normalize(pvaIn.ecUnitNormal), 1.0);
+    gDepth = -(view * vec4(fragPos, 1.0)).z;
+}
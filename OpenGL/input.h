@@ -0,0 +1,251 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "scene.h"
+
+// Every action the scene reacts to, one bit each. Keeping input as plain data (instead of
+// polling GLFW from the code that moves the car and cameras) lets a frame's input be
+// recorded to a file and fed back later, so two runs drive the scene along the same path.
+enum InputAction : uint32_t
+{
+    INPUT_QUIT              = 1u << 0,
+    INPUT_CAMERA_FORWARD    = 1u << 1,
+    INPUT_CAMERA_BACKWARD   = 1u << 2,
+    INPUT_CAMERA_LEFT       = 1u << 3,
+    INPUT_CAMERA_RIGHT      = 1u << 4,
+    INPUT_NIGHT             = 1u << 5,
+    INPUT_DAY               = 1u << 6,
+    INPUT_CAR_FORWARD       = 1u << 7,
+    INPUT_CAR_BACKWARD      = 1u << 8,
+    INPUT_CAR_TURN_LEFT     = 1u << 9,
+    INPUT_CAR_TURN_RIGHT    = 1u << 10,
+    INPUT_CAR_UP            = 1u << 11,
+    INPUT_CAR_DOWN          = 1u << 12,
+    INPUT_FLYING_CAMERA     = 1u << 13,
+    INPUT_CAR_CAMERA        = 1u << 14,
+    INPUT_STATIC_CAMERA     = 1u << 15,
+    INPUT_SPOTLIGHT_UP      = 1u << 16,
+    INPUT_SPOTLIGHT_DOWN    = 1u << 17,
+    INPUT_FOG_UP            = 1u << 18,
+    INPUT_FOG_DOWN          = 1u << 19,
+    INPUT_BLINN             = 1u << 20,
+    INPUT_PHONG             = 1u << 21,
+    INPUT_SHOW_DEBUG        = 1u << 22,
+    INPUT_HIDE_DEBUG        = 1u << 23
+};
+
+// input gathered during one frame together with the time step it applies to
+struct FrameInput
+{
+    uint32_t actions = 0;
+    float deltaTime = 0.0f;
+    // mouse movement and scroll accumulated since the previous frame
+    float mouseX = 0.0f;
+    float mouseY = 0.0f;
+    float scroll = 0.0f;
+
+    bool has(InputAction action) const
+    {
+        return (actions & action) != 0;
+    }
+};
+
+// moves the car, cameras, fog and time of day according to one frame of input.
+// UI-only actions (quit, debug window) are left to the caller.
+inline void applyInput(Scene &scene, const FrameInput &input)
+{
+    PROFILE_ZONE("Apply input");
+
+    float frametime = input.deltaTime;
+
+    if (input.has(INPUT_CAMERA_FORWARD))
+        scene.mainCamera.ProcessKeyboard(FORWARD, frametime);
+    if (input.has(INPUT_CAMERA_BACKWARD))
+        scene.mainCamera.ProcessKeyboard(BACKWARD, frametime);
+    if (input.has(INPUT_CAMERA_LEFT))
+        scene.mainCamera.ProcessKeyboard(LEFT, frametime);
+    if (input.has(INPUT_CAMERA_RIGHT))
+        scene.mainCamera.ProcessKeyboard(RIGHT, frametime);
+
+    if (input.has(INPUT_NIGHT))
+        scene.current_time_of_day = NIGHT;
+    if (input.has(INPUT_DAY))
+        scene.current_time_of_day = DAY;
+
+    if (input.has(INPUT_CAR_FORWARD))
+        scene.car.move(frametime * 2.0f);
+    if (input.has(INPUT_CAR_BACKWARD))
+        scene.car.move(-frametime * 2.0f);
+    if (input.has(INPUT_CAR_TURN_LEFT))
+        scene.car.rotate(frametime * 2.0f);
+    if (input.has(INPUT_CAR_TURN_RIGHT))
+        scene.car.rotate(-frametime * 2.0f);
+    if (input.has(INPUT_CAR_UP))
+        scene.car.position.y += frametime * 2.0f;
+    if (input.has(INPUT_CAR_DOWN))
+        scene.car.position.y -= frametime * 2.0f;
+
+    if (input.has(INPUT_FLYING_CAMERA))
+        scene.activeCamera = &scene.mainCamera;
+    if (input.has(INPUT_CAR_CAMERA))
+        scene.activeCamera = &scene.carCamera;
+    if (input.has(INPUT_STATIC_CAMERA))
+        scene.activeCamera = &scene.staticCamera;
+
+    if (input.has(INPUT_SPOTLIGHT_UP))
+        scene.car.rotateSpotlight(-frametime * 0.2f);
+    if (input.has(INPUT_SPOTLIGHT_DOWN))
+        scene.car.rotateSpotlight(frametime * 0.2f);
+
+    if (input.has(INPUT_FOG_UP))
+        scene.fogIntensity += frametime * 0.1f;
+    if (input.has(INPUT_FOG_DOWN))
+    {
+        scene.fogIntensity -= frametime * 0.1f;
+        if (scene.fogIntensity < 0.0f) scene.fogIntensity = 0.0f;
+    }
+
+    if (input.has(INPUT_BLINN))
+        scene.blinn = true;
+    if (input.has(INPUT_PHONG))
+        scene.blinn = false;
+
+    if (input.mouseX != 0.0f || input.mouseY != 0.0f)
+        scene.activeCamera->ProcessMouseMovement(input.mouseX, input.mouseY);
+    if (input.scroll != 0.0f)
+        scene.activeCamera->ProcessMouseScroll(input.scroll);
+}
+
+// Input log file layout (little endian):
+//   header: char magic[4] = "OGLI", uint32_t version
+//   then one record per frame: uint32_t actions, float deltaTime, float mouseX, float mouseY, float scroll
+const char INPUT_LOG_MAGIC[4] = { 'O', 'G', 'L', 'I' };
+const uint32_t INPUT_LOG_VERSION = 1;
+
+// writes one FrameInput per frame to a binary input log
+class InputRecorder
+{
+public:
+    ~InputRecorder()
+    {
+        close();
+    }
+
+    bool open(const std::string &path)
+    {
+        close();
+        file = std::fopen(path.c_str(), "wb");
+        if (!file)
+        {
+            std::cerr << "ERROR::INPUT::CANNOT_OPEN_RECORDING: " << path << std::endl;
+            return false;
+        }
+        std::fwrite(INPUT_LOG_MAGIC, 1, sizeof(INPUT_LOG_MAGIC), file);
+        std::fwrite(&INPUT_LOG_VERSION, sizeof(INPUT_LOG_VERSION), 1, file);
+        return true;
+    }
+
+    bool isOpen() const
+    {
+        return file != nullptr;
+    }
+
+    void write(const FrameInput &input)
+    {
+        if (!file)
+            return;
+        std::fwrite(&input.actions, sizeof(input.actions), 1, file);
+        std::fwrite(&input.deltaTime, sizeof(input.deltaTime), 1, file);
+        std::fwrite(&input.mouseX, sizeof(input.mouseX), 1, file);
+        std::fwrite(&input.mouseY, sizeof(input.mouseY), 1, file);
+        std::fwrite(&input.scroll, sizeof(input.scroll), 1, file);
+    }
+
+    void close()
+    {
+        if (file)
+            std::fclose(file);
+        file = nullptr;
+    }
+
+private:
+    FILE *file = nullptr;
+};
+
+// reads a binary input log back frame by frame.
+// With a fixed timestep every frame advances by that step instead of the recorded delta time.
+class InputPlayer
+{
+public:
+    float fixedTimestep = 0.0f;
+
+    ~InputPlayer()
+    {
+        close();
+    }
+
+    bool open(const std::string &path)
+    {
+        close();
+        file = std::fopen(path.c_str(), "rb");
+        if (!file)
+        {
+            std::cerr << "ERROR::INPUT::CANNOT_OPEN_REPLAY: " << path << std::endl;
+            return false;
+        }
+        char magic[4];
+        uint32_t version = 0;
+        if (std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) || std::memcmp(magic, INPUT_LOG_MAGIC, sizeof(magic)) != 0
+            || std::fread(&version, sizeof(version), 1, file) != 1 || version != INPUT_LOG_VERSION)
+        {
+            std::cerr << "ERROR::INPUT::NOT_AN_INPUT_LOG: " << path << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    bool isOpen() const
+    {
+        return file != nullptr;
+    }
+
+    // returns false once the log is exhausted
+    bool next(FrameInput &input)
+    {
+        if (!file)
+            return false;
+        FrameInput record;
+        if (std::fread(&record.actions, sizeof(record.actions), 1, file) != 1
+            || std::fread(&record.deltaTime, sizeof(record.deltaTime), 1, file) != 1
+            || std::fread(&record.mouseX, sizeof(record.mouseX), 1, file) != 1
+            || std::fread(&record.mouseY, sizeof(record.mouseY), 1, file) != 1
+            || std::fread(&record.scroll, sizeof(record.scroll), 1, file) != 1)
+        {
+            close();
+            return false;
+        }
+        if (fixedTimestep > 0.0f)
+            record.deltaTime = fixedTimestep;
+        input = record;
+        return true;
+    }
+
+    void close()
+    {
+        if (file)
+            std::fclose(file);
+        file = nullptr;
+    }
+
+private:
+    FILE *file = nullptr;
+};
+
+#endif
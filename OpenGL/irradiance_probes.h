@@ -0,0 +1,183 @@
+#ifndef IRRADIANCE_PROBES_H
+#define IRRADIANCE_PROBES_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <learnopengl/storage_buffer.h>
+
+#include "light.h"
+#include "uniform_blocks.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// What probe_baker writes and IrradianceProbes reads: a grid of probes over de_dust2, x fastest,
+// then y, then z, each with the L2 spherical harmonics (9 coefficients, RGB) of the irradiance
+// arriving at it, convolved with the cosine lobe and divided by pi. Two sets per probe, since
+// the sun and the moon share a direction but not their colours: sky, the light of the sky and of
+// the surfaces it lights, per unit of the sun's ambient colour; and sun, the sunlight bounced
+// off the sunlit surfaces, per unit of its diffuse colour. A probe with most of its rays hitting
+// back faces is inside a wall and marked not valid.
+//
+// file: "PROB", version, probes along x, y and z, then the first probe's position and the
+// spacing as floats, then per probe its 27 sky and 27 sun coefficients (coefficient-major, RGB)
+// as half floats, then a byte per probe, 1 if valid; all little-endian
+struct IrradianceProbeData
+{
+    static const uint32_t VERSION = 1;
+    // half floats per probe: two sets of 9 RGB coefficients
+    static const int COEFFICIENTS = 54;
+
+    glm::ivec3 size = glm::ivec3(0);
+    glm::vec3 origin = glm::vec3(0.0f);
+    float spacing = 0.0f;
+    // packed with glm::packHalf1x16
+    std::vector<uint16_t> coefficients;
+    std::vector<uint8_t> valid;
+
+    size_t probeCount() const
+    {
+        return (size_t)size.x * size.y * size.z;
+    }
+
+    bool write(const std::string &path) const
+    {
+        FILE *file = std::fopen(path.c_str(), "wb");
+        if (!file)
+        {
+            std::cout << "ERROR::PROBES::FILE_NOT_WRITTEN: " << path << std::endl;
+            return false;
+        }
+        uint32_t header[5] = { magic(), VERSION, (uint32_t)size.x, (uint32_t)size.y, (uint32_t)size.z };
+        float grid[4] = { origin.x, origin.y, origin.z, spacing };
+        bool ok = std::fwrite(header, sizeof(header), 1, file) == 1 && std::fwrite(grid, sizeof(grid), 1, file) == 1;
+        ok = ok && std::fwrite(coefficients.data(), sizeof(uint16_t), coefficients.size(), file) == coefficients.size();
+        ok = ok && std::fwrite(valid.data(), 1, valid.size(), file) == valid.size();
+        ok = std::fclose(file) == 0 && ok;
+        if (!ok)
+            std::cout << "ERROR::PROBES::FILE_NOT_WRITTEN: " << path << std::endl;
+        return ok;
+    }
+
+    // false without a message if the file does not exist (nothing was baked yet)
+    bool read(const std::string &path)
+    {
+        FILE *file = std::fopen(path.c_str(), "rb");
+        if (!file)
+            return false;
+        uint32_t header[5];
+        float grid[4];
+        bool ok = std::fread(header, sizeof(header), 1, file) == 1 && header[0] == magic() && header[1] == VERSION
+                  && std::fread(grid, sizeof(grid), 1, file) == 1;
+        if (ok)
+        {
+            size = glm::ivec3(header[2], header[3], header[4]);
+            origin = glm::vec3(grid[0], grid[1], grid[2]);
+            spacing = grid[3];
+            // trilinear interpolation needs two probes along every axis
+            ok = glm::all(glm::greaterThanEqual(size, glm::ivec3(2))) && spacing > 0.0f;
+        }
+        if (ok)
+        {
+            coefficients.resize(probeCount() * COEFFICIENTS);
+            valid.resize(probeCount());
+            ok = std::fread(coefficients.data(), sizeof(uint16_t), coefficients.size(), file) == coefficients.size()
+                 && std::fread(valid.data(), 1, valid.size(), file) == valid.size();
+        }
+        std::fclose(file);
+        if (!ok)
+            std::cout << "ERROR::PROBES::FILE_NOT_READ: " << path << std::endl;
+        return ok;
+    }
+
+private:
+    static uint32_t magic()
+    {
+        return 'P' | 'R' << 8 | 'O' << 16 | 'B' << 24;
+    }
+};
+
+// Baked irradiance probes on the GPU, the ambient light of the dynamic objects: the containers,
+// the car and the flag sample the 8 probes around each fragment (probes.glsl) instead of the
+// sun's flat ambient. update() tints the two baked sets by the current sun or moon and uploads
+// the result to the storage buffer, only when its colours changed, so a frame costs nothing.
+class IrradianceProbes
+{
+public:
+    // vec4 per probe in the storage buffer: 27 coefficients and the valid flag
+    static const int VEC4S_PER_PROBE = 7;
+
+    IrradianceProbes()
+        : buffer(IRRADIANCE_PROBES_BINDING), uploadedAmbient(-1.0f), uploadedDiffuse(-1.0f)
+    {
+    }
+
+    IrradianceProbes(const IrradianceProbes &) = delete;
+    IrradianceProbes &operator=(const IrradianceProbes &) = delete;
+
+    // false if there is no probe file
+    bool load(const std::string &path)
+    {
+        if (!data.read(path))
+            return false;
+        // force the next update() to upload
+        uploadedAmbient = glm::vec3(-1.0f);
+        return true;
+    }
+
+    bool loaded() const
+    {
+        return data.probeCount() > 0;
+    }
+
+    size_t probeCount() const
+    {
+        return data.probeCount();
+    }
+
+    // uploads the probes lit by light if its colours changed since the last upload
+    void update(const dir_light &light)
+    {
+        if (!loaded() || (light.ambient == uploadedAmbient && light.diffuse == uploadedDiffuse))
+            return;
+        std::vector<glm::vec4> probes(data.probeCount() * VEC4S_PER_PROBE);
+        for (size_t probe = 0; probe < data.probeCount(); probe++)
+        {
+            const uint16_t *sky = &data.coefficients[probe * IrradianceProbeData::COEFFICIENTS];
+            const uint16_t *sun = sky + IrradianceProbeData::COEFFICIENTS / 2;
+            float *out = &probes[probe * VEC4S_PER_PROBE].x;
+            for (int i = 0; i < IrradianceProbeData::COEFFICIENTS / 2; i++)
+                out[i] = light.ambient[i % 3] * glm::unpackHalf1x16(sky[i]) + light.diffuse[i % 3] * glm::unpackHalf1x16(sun[i]);
+            out[VEC4S_PER_PROBE * 4 - 1] = data.valid[probe] ? 1.0f : 0.0f;
+        }
+        buffer.upload(probes);
+        uploadedAmbient = light.ambient;
+        uploadedDiffuse = light.diffuse;
+    }
+
+    // the grid for the shaders; without enabled (or probes) they keep the flat ambient
+    void describe(lighting_block &lighting, bool enabled) const
+    {
+        lighting.probeGridOrigin = glm::vec4(data.origin, data.spacing);
+        lighting.probeGridSize = glm::ivec4(data.size, enabled && loaded() ? 1 : 0);
+    }
+
+    // 0 without probes: the buffer then only holds the element that lets it be bound
+    size_t gpuBytes() const
+    {
+        return loaded() ? buffer.gpuBytes() : 0;
+    }
+
+private:
+    IrradianceProbeData data;
+    StorageBuffer<glm::vec4> buffer;
+    glm::vec3 uploadedAmbient, uploadedDiffuse;
+};
+
+#endif
@@ -2,7 +2,87 @@
 #define LIGHT_H
 
 #include <glm/glm.hpp>
-#include <learnopengl/shader.h>
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+// The *_std140 structs mirror the GLSL DirLight / PointLight / SpotLight structs byte for byte
+// (see uniform_blocks.h): under std140 a vec3 is aligned to 16 bytes, a following float may fill
+// its last 4 bytes, and structs round up to 16 bytes. Every member here is 16-byte aligned already,
+// so the std430 arrays of the PointLights / SpotLights storage buffers use the same layout.
+
+struct dir_light_std140
+{
+	glm::vec3 direction; float pad0;
+	glm::vec3 ambient; float pad1;
+	glm::vec3 diffuse; float pad2;
+	glm::vec3 specular; float pad3;
+};
+static_assert(sizeof(dir_light_std140) == 64, "DirLight std140 size");
+
+struct point_light_std140
+{
+	glm::vec3 position;
+	float constant;
+	float linear;
+	float quadratic;
+	float radius;
+	float pad0;
+	glm::vec3 ambient; float pad1;
+	glm::vec3 diffuse; float pad2;
+	glm::vec3 specular; float pad3;
+};
+static_assert(offsetof(point_light_std140, radius) == 24, "PointLight std140 layout");
+static_assert(offsetof(point_light_std140, ambient) == 32, "PointLight std140 layout");
+static_assert(sizeof(point_light_std140) == 80, "PointLight std140 size");
+
+struct spotlight_std140
+{
+	glm::vec3 position;
+	float radius;
+	glm::vec3 direction;
+	float cutOff;
+	float outerCutOff;
+	float constant;
+	float linear;
+	float quadratic;
+	glm::vec3 ambient;
+	int shadowLayer;
+	glm::vec3 diffuse; float pad2;
+	glm::vec3 specular; float pad3;
+};
+static_assert(offsetof(spotlight_std140, radius) == 12, "SpotLight std140 layout");
+static_assert(offsetof(spotlight_std140, ambient) == 48, "SpotLight std140 layout");
+static_assert(offsetof(spotlight_std140, shadowLayer) == 60, "SpotLight std140 layout");
+static_assert(sizeof(spotlight_std140) == 96, "SpotLight std140 size");
+
+// Contribution below which a light is lost among the others: the clustered and per-object
+// paths do not shade a light where it would add less than this to a colour channel.
+const float LIGHT_CUTOFF = 5.0f / 256.0f;
+
+// Distance at which a light with the given attenuation and brightest colour component falls
+// below LIGHT_CUTOFF. Used to cull lights into clusters and onto objects; anything beyond the
+// range is not shaded by those paths.
+inline float light_range(float constant, float linear, float quadratic, float intensity)
+{
+	// solve constant + linear * d + quadratic * d^2 = intensity / LIGHT_CUTOFF
+	float c = constant - intensity / LIGHT_CUTOFF;
+	if (c >= 0.0f)
+		return 0.0f;
+	if (quadratic > 0.0f)
+		return (-linear + std::sqrt(linear * linear - 4.0f * quadratic * c)) / (2.0f * quadratic);
+	if (linear > 0.0f)
+		return -c / linear;
+	return std::numeric_limits<float>::max();
+}
+
+// the shaders double the specular term
+inline float light_intensity(const glm::vec3 &ambient, const glm::vec3 &diffuse, const glm::vec3 &specular)
+{
+	glm::vec3 brightest = glm::max(ambient + diffuse, 2.0f * specular);
+	return glm::max(brightest.x, glm::max(brightest.y, brightest.z));
+}
 
 struct dir_light
 {
@@ -11,12 +91,14 @@ struct dir_light
 	glm::vec3 diffuse;
 	glm::vec3 specular;
 
-	void apply(Shader &shader)
+	dir_light_std140 std140() const
 	{
-		shader.setVec3("dirLight.direction", direction);
-		shader.setVec3("dirLight.ambient", ambient);
-		shader.setVec3("dirLight.diffuse", diffuse);
-		shader.setVec3("dirLight.specular", specular);
+		dir_light_std140 gpu = {};
+		gpu.direction = direction;
+		gpu.ambient = ambient;
+		gpu.diffuse = diffuse;
+		gpu.specular = specular;
+		return gpu;
 	}
 };
 
@@ -32,15 +114,23 @@ struct point_light
 	glm::vec3 diffuse;
 	glm::vec3 specular;
 
-	void apply(Shader &shader, int i)
+	float range() const
 	{
-		shader.setVec3("pointLights[" + std::to_string(i) + "].position", position);
-		shader.setFloat("pointLights[" + std::to_string(i) + "].constant", constant);
-		shader.setFloat("pointLights[" + std::to_string(i) + "].linear", linear);
-		shader.setFloat("pointLights[" + std::to_string(i) + "].quadratic", quadratic);
-		shader.setVec3("pointLights[" + std::to_string(i) + "].ambient", ambient);
-		shader.setVec3("pointLights[" + std::to_string(i) + "].diffuse", diffuse);
-		shader.setVec3("pointLights[" + std::to_string(i) + "].specular", specular);
+		return light_range(constant, linear, quadratic, light_intensity(ambient, diffuse, specular));
+	}
+
+	point_light_std140 std140() const
+	{
+		point_light_std140 gpu = {};
+		gpu.position = position;
+		gpu.constant = constant;
+		gpu.linear = linear;
+		gpu.quadratic = quadratic;
+		gpu.radius = range();
+		gpu.ambient = ambient;
+		gpu.diffuse = diffuse;
+		gpu.specular = specular;
+		return gpu;
 	}
 };
 
@@ -59,21 +149,44 @@ struct spotlight
 	glm::vec3 diffuse;
 	glm::vec3 specular;
 
-	void apply(Shader &shader, int i)
+	// layer of the spot shadow map (spot_shadows.h), -1: casts no shadows
+	int shadowLayer = -1;
+
+	// bounds the cone by a sphere around the apex
+	float range() const
+	{
+		return light_range(constant, linear, quadratic, light_intensity(ambient, diffuse, specular));
+	}
+
+	// cosine of the cone's half angle: the shaders' pow(cos, 32) falloff leaves less than
+	// LIGHT_CUTOFF outside it, even at the apex
+	float coneCos() const
+	{
+		float intensity = light_intensity(ambient, diffuse, specular);
+		if (intensity <= LIGHT_CUTOFF)
+			return 1.0f;
+		return std::pow(LIGHT_CUTOFF / intensity, 1.0f / 32.0f);
+	}
+
+	spotlight_std140 std140() const
 	{
-		shader.setVec3("spotLights[" + std::to_string(i) + "].position", position);
-		shader.setVec3("spotLights[" + std::to_string(i) + "].direction", direction);
-		shader.setFloat("spotLights[" + std::to_string(i) + "].cutOff", cutOff);
-		shader.setFloat("spotLights[" + std::to_string(i) + "].outerCutOff", outerCutOff);
-		shader.setFloat("spotLights[" + std::to_string(i) + "].constant", constant);
-		shader.setFloat("spotLights[" + std::to_string(i) + "].linear", linear);
-		shader.setFloat("spotLights[" + std::to_string(i) + "].quadratic", quadratic);
-		shader.setVec3("spotLights[" + std::to_string(i) + "].ambient", ambient);
-		shader.setVec3("spotLights[" + std::to_string(i) + "].diffuse", diffuse);
-		shader.setVec3("spotLights[" + std::to_string(i) + "].specular", specular);
+		spotlight_std140 gpu = {};
+		gpu.position = position;
+		gpu.radius = range();
+		gpu.direction = direction;
+		gpu.cutOff = cutOff;
+		gpu.outerCutOff = outerCutOff;
+		gpu.constant = constant;
+		gpu.linear = linear;
+		gpu.quadratic = quadratic;
+		gpu.ambient = ambient;
+		gpu.shadowLayer = shadowLayer;
+		gpu.diffuse = diffuse;
+		gpu.specular = specular;
+		return gpu;
 	}
 };
 
 
 
-#endif
\ No newline at end of file
+#endif
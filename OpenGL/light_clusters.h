@@ -0,0 +1,95 @@
+#ifndef LIGHT_CLUSTERS_H
+#define LIGHT_CLUSTERS_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/shader_t.h>
+
+#include "uniform_blocks.h"
+
+#include <cmath>
+
+// Clustered forward shading: the view frustum is split into a GRID_X x GRID_Y x GRID_Z grid of
+// froxels (screen tiles times exponential depth slices). Each frame cluster_lights.comp tests
+// every point light and spotlight sphere against every froxel and writes the indices of the
+// touching lights, so a fragment only loops over the lights of its own froxel.
+//
+// Depth slice 0 spans [near plane, CLUSTER_NEAR]; the remaining slices split
+// [CLUSTER_NEAR, far plane] exponentially, so froxels stay roughly cubic with distance.
+class LightClusters
+{
+public:
+    static const int GRID_X = 16;
+    static const int GRID_Y = 9;
+    static const int GRID_Z = 24;
+    static const int COUNT = GRID_X * GRID_Y * GRID_Z;
+    // lights beyond this per froxel are dropped: point lights first, then spotlights
+    static const int MAX_LIGHTS_PER_CLUSTER = 128;
+    static constexpr float CLUSTER_NEAR = 0.5f;
+
+    // threads per work group of cluster_lights.comp, one thread per froxel
+    static const int WORK_GROUP_SIZE = 64;
+
+    LightClusters()
+        : cullShader("cluster_lights.comp")
+    {
+        glGenBuffers(1, &countsBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, countsBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, COUNT * 2 * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+        glGenBuffers(1, &indicesBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, indicesBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, COUNT * MAX_LIGHTS_PER_CLUSTER * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_LIGHT_COUNTS_BINDING, countsBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_LIGHT_INDICES_BINDING, indicesBuffer);
+
+        inverseProjectionUniform = cullShader.uniform("inverseProjection");
+        zNearUniform = cullShader.uniform("zNear");
+    }
+
+    ~LightClusters()
+    {
+        glDeleteBuffers(1, &countsBuffer);
+        glDeleteBuffers(1, &indicesBuffer);
+    }
+
+    LightClusters(const LightClusters &) = delete;
+    LightClusters &operator=(const LightClusters &) = delete;
+
+    // the grid parameters the fragment shaders need to find their froxel
+    void describe(lighting_block &lighting, glm::vec2 screenSize, float zFar) const
+    {
+        lighting.clusterGrid = glm::ivec4(GRID_X, GRID_Y, GRID_Z, MAX_LIGHTS_PER_CLUSTER);
+        lighting.screenSize = screenSize;
+        lighting.clusterScale = (GRID_Z - 1) / std::log(zFar / CLUSTER_NEAR);
+        lighting.clusterNear = CLUSTER_NEAR;
+    }
+
+    // bins the lights of the LightRegistry buffers; the Camera and Lighting blocks and the
+    // light buffers must be uploaded for this frame already
+    void cull(const glm::mat4 &projection, float zNear)
+    {
+        cullShader.use();
+        cullShader.setMat4(inverseProjectionUniform, glm::inverse(projection));
+        cullShader.setFloat(zNearUniform, zNear);
+        glDispatchCompute((COUNT + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, 1, 1);
+        // the fragment shaders read the lists written above
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    size_t gpuBytes() const
+    {
+        return (size_t)COUNT * (2 + MAX_LIGHTS_PER_CLUSTER) * sizeof(GLuint);
+    }
+
+private:
+    Shader cullShader;
+    Shader::Uniform inverseProjectionUniform;
+    Shader::Uniform zNearUniform;
+    unsigned int countsBuffer, indicesBuffer;
+};
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef LIGHT_REGISTRY_H
+#define LIGHT_REGISTRY_H
+
+#include <learnopengl/storage_buffer.h>
+
+#include "light.h"
+#include "uniform_blocks.h"
+
+#include <vector>
+
+// All point lights and spotlights of the scene. The shaders loop over every light in the
+// PointLights / SpotLights shader storage buffers, whose sizes follow the registry, so the
+// number of lights is only limited by memory and fragment cost.
+// Lights are addressed by the index returned when they are added; edit them through
+// pointLight() / spotLight() and call upload() once per frame before drawing.
+class LightRegistry
+{
+public:
+    LightRegistry()
+        : pointLightBuffer(POINT_LIGHTS_BINDING),
+          spotlightBuffer(SPOTLIGHTS_BINDING)
+    {
+    }
+
+    int addPointLight(const point_light &light)
+    {
+        pointLights.push_back(light);
+        return (int)pointLights.size() - 1;
+    }
+
+    int addSpotlight(const spotlight &light)
+    {
+        spotlights.push_back(light);
+        return (int)spotlights.size() - 1;
+    }
+
+    point_light &pointLight(int index)
+    {
+        return pointLights[index];
+    }
+
+    spotlight &spotLight(int index)
+    {
+        return spotlights[index];
+    }
+
+    const point_light &pointLight(int index) const
+    {
+        return pointLights[index];
+    }
+
+    const spotlight &spotLight(int index) const
+    {
+        return spotlights[index];
+    }
+
+    int pointLightCount() const
+    {
+        return (int)pointLights.size();
+    }
+
+    int spotlightCount() const
+    {
+        return (int)spotlights.size();
+    }
+
+    // converts the lights to their GPU layout and writes both storage buffers
+    void upload()
+    {
+        gpuPointLights.resize(pointLights.size());
+        for (size_t i = 0; i < pointLights.size(); i++)
+            gpuPointLights[i] = pointLights[i].std140();
+        pointLightBuffer.upload(gpuPointLights);
+
+        gpuSpotlights.resize(spotlights.size());
+        for (size_t i = 0; i < spotlights.size(); i++)
+            gpuSpotlights[i] = spotlights[i].std140();
+        spotlightBuffer.upload(gpuSpotlights);
+    }
+
+    size_t gpuBytes() const
+    {
+        return pointLightBuffer.gpuBytes() + spotlightBuffer.gpuBytes();
+    }
+
+private:
+    std::vector<point_light> pointLights;
+    std::vector<spotlight> spotlights;
+
+    // reused every frame to avoid reallocating
+    std::vector<point_light_std140> gpuPointLights;
+    std::vector<spotlight_std140> gpuSpotlights;
+
+    StorageBuffer<point_light_std140> pointLightBuffer;
+    StorageBuffer<spotlight_std140> spotlightBuffer;
+};
+
+#endif
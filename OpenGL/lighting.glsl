@@ -0,0 +1,220 @@
+// Lighting shared by the forward shaders and the deferred light pass. The including shader
+// describes its surface with a Material, sampling its textures once per fragment, and passes it
+// to the Calc*Light functions or to ShadeForward().
+#include "scene_blocks.glsl"
+#include "fog.glsl"
+#include "shadows.glsl"
+#include "probes.glsl"
+#include "features.glsl"
+
+// per-froxel light lists written by cluster_lights.comp
+layout (std430, binding = 4) readonly buffer ClusterLightCounts
+{
+    uvec2 clusterLightCounts[];
+};
+
+layout (std430, binding = 5) readonly buffer ClusterLightIndices
+{
+    uint clusterLightIndices[];
+};
+
+#ifdef OBJECT_LIGHTS
+// per-draw light lists built on the CPU (object_lights.h)
+layout (std430, binding = 6) readonly buffer ObjectLightIndices
+{
+    uint objectLightIndices[];
+};
+
+// this draw's list in objectLightIndices: first index, point lights, spotlights
+layout (location = 12) uniform ivec3 objectLights;
+#endif
+
+struct Material {
+    vec3 diffuse;            // ambient and diffuse colour
+    vec3 specular;           // specular colour
+    vec3 spotSpecular;       // extra factor on the headlights' specular
+    float pointDiffuseScale; // extra factor on the point lights' diffuse
+    float shininess;
+};
+
+// the usual material: no extra factors
+Material MakeMaterial(vec3 diffuse, vec3 specular, float shininess)
+{
+    Material material;
+    material.diffuse = diffuse;
+    material.specular = specular;
+    material.spotSpecular = vec3(1.0);
+    material.pointDiffuseScale = 1.0;
+    material.shininess = shininess;
+    return material;
+}
+
+float CalcSpecular(Material material, vec3 lightDir, vec3 normal, vec3 viewDir)
+{
+    if (BLINN_ENABLED)
+        return pow(max(dot(normal, normalize(lightDir + viewDir)), 0.0), material.shininess);
+    vec3 reflectDir = reflect(-lightDir, normal);
+    return pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+}
+
+// calculates the color when using a directional light.
+// shadow is the fraction of the light reaching the fragment (CalcSunShadow); ambient ignores it
+vec3 CalcDirLight(DirLight light, Material material, vec3 normal, vec3 viewDir, float shadow)
+{
+    vec3 lightDir = normalize(-light.direction);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    float spec = CalcSpecular(material, lightDir, normal, viewDir);
+    // combine results
+    vec3 ambient = light.ambient * material.diffuse;
+    vec3 diffuse = light.diffuse * diff * material.diffuse;
+    vec3 specular = light.specular * spec * material.specular;
+    return (ambient + shadow * (diffuse + specular));
+}
+
+// calculates the color when using a point light.
+vec3 CalcPointLight(PointLight light, Material material, vec3 normal, vec3 fragPos, vec3 viewDir)
+{
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    float spec = CalcSpecular(material, lightDir, normal, viewDir);
+    // attenuation
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+    // combine results
+    vec3 ambient = light.ambient * material.diffuse;
+    vec3 diffuse = material.pointDiffuseScale * light.diffuse * diff * material.diffuse;
+    vec3 specular = light.specular * spec * material.specular;
+    ambient *= attenuation;
+    diffuse *= attenuation;
+    specular *= attenuation;
+    return (ambient + diffuse + specular);
+}
+
+// calculates the color when using a spot light; ambient ignores its shadow (CalcSpotShadow)
+vec3 CalcSpotLight(SpotLight light, Material material, vec3 normal, vec3 fragPos, vec3 viewDir)
+{
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    float spec = CalcSpecular(material, lightDir, normal, viewDir);
+    // attenuation
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+    // spotlight intensity
+    float theta = dot(lightDir, normalize(-light.direction));
+    //float epsilon = light.cutOff - light.outerCutOff;
+    //float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    float intensity = pow(max(theta, 0.0), 32);
+    // combine results
+    vec3 ambient = light.ambient * material.diffuse;
+    vec3 diffuse = light.diffuse * diff * material.diffuse;
+    vec3 specular = light.specular * spec * material.specular * material.spotSpecular;
+    ambient *= attenuation * intensity;
+    diffuse *= attenuation * intensity;
+    specular *= attenuation * intensity;
+    return (ambient + CalcSpotShadow(light, fragPos, normal) * (diffuse + specular));
+}
+
+// froxel of a fragment: screen tile from gl_FragCoord, depth slice from the view-space distance
+uint ClusterIndex(vec3 worldPos)
+{
+    float depth = -(view * vec4(worldPos, 1.0)).z;
+    int slice = depth < clusterNear ? 0 : min(clusterGrid.z - 1, 1 + int(log(depth / clusterNear) * clusterScale));
+    ivec2 tile = min(ivec2(gl_FragCoord.xy / screenSize * vec2(clusterGrid.xy)), clusterGrid.xy - 1);
+    return uint(tile.x + clusterGrid.x * (tile.y + clusterGrid.y * slice));
+}
+
+// blue (no lights) through green to red (a full cluster)
+vec3 HeatmapColor(uint lightCount)
+{
+    float t = clamp(float(lightCount) / float(clusterGrid.w), 0.0, 1.0);
+    return t < 0.5 ? mix(vec3(0.0, 0.0, 1.0), vec3(0.0, 1.0, 0.0), t * 2.0)
+                   : mix(vec3(0.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0), t * 2.0 - 1.0);
+}
+
+// light baked offline: the irradiance a lightmap (lightmap.h) holds of the point lights below
+// firstPointLight, which are not shaded again, and the sun's ambient light reaching the fragment,
+// darkened by the lightmap's occlusion or taken from the irradiance probes
+struct BakedLight {
+    vec3 irradiance;
+    vec3 ambient;
+    int firstPointLight;
+};
+
+// the baked light of a dynamic object: only its ambient, from the irradiance probes
+BakedLight ProbeLight(vec3 fragPos, vec3 normal)
+{
+    return BakedLight(vec3(0.0), SampleProbeAmbient(fragPos, normal), 0);
+}
+
+// final colour of a forward-shaded fragment, on top of baked light
+vec3 ShadeForward(Material material, vec3 normal, vec3 fragPos, BakedLight baked)
+{
+    vec3 viewDir = normalize(viewPos - fragPos);
+
+    // == =====================================================
+    // Our lighting is set up in 3 phases: directional, point lights and an optional flashlight
+    // For each phase, a calculate function is defined that calculates the corresponding color
+    // per lamp. Here we take all the calculated colors and sum them up for
+    // this fragment's final color.
+    // == =====================================================
+    // phase 1: directional lighting
+    DirLight sky = dirLight;
+    sky.ambient = baked.ambient;
+    vec3 result = CalcDirLight(sky, material, normal, viewDir, CalcSunShadow(fragPos, normal));
+    // the baked lights' ambient and diffuse, without their specular
+    result += baked.irradiance * material.diffuse;
+#ifdef CLUSTERED
+    // only the lights whose range reaches this fragment's froxel
+    uint cluster = ClusterIndex(fragPos);
+    uint first = cluster * uint(clusterGrid.w);
+    uvec2 counts = clusterLightCounts[cluster];
+#ifdef HEATMAP
+    return HeatmapColor(counts.x + counts.y);
+#endif
+    // phase 2: point lights
+    for(uint i = 0; i < counts.x; i++)
+    {
+        uint index = clusterLightIndices[first + i];
+        if (int(index) >= baked.firstPointLight)
+            result += CalcPointLight(pointLights[index], material, normal, fragPos, viewDir);
+    }
+    // phase 3: spot light
+    for(uint i = 0; i < counts.y; i++)
+        result += CalcSpotLight(spotLights[clusterLightIndices[first + counts.x + i]], material, normal, fragPos, viewDir);
+#elif defined(OBJECT_LIGHTS)
+    // only the lights whose range reaches the drawn object
+    // phase 2: point lights
+    for(int i = 0; i < objectLights.y; i++)
+    {
+        uint index = objectLightIndices[objectLights.x + i];
+        if (int(index) >= baked.firstPointLight)
+            result += CalcPointLight(pointLights[index], material, normal, fragPos, viewDir);
+    }
+    // phase 3: spot light
+    for(int i = 0; i < objectLights.z; i++)
+        result += CalcSpotLight(spotLights[objectLightIndices[objectLights.x + objectLights.y + i]], material, normal, fragPos, viewDir);
+#else
+    // phase 2: point lights
+    for(int i = baked.firstPointLight; i < pointLightCount; i++)
+        result += CalcPointLight(pointLights[i], material, normal, fragPos, viewDir);
+    // phase 3: spot light
+    for(int i = 0; i < spotLightCount; i++)
+        result += CalcSpotLight(spotLights[i], material, normal, fragPos, viewDir);
+#endif
+
+    if (FOG_ENABLED)
+        result = mix(fogColor, result, CalcFogFactor(length(viewPos - fragPos)));
+    return result;
+}
+
+// final colour of a forward-shaded fragment
+vec3 ShadeForward(Material material, vec3 normal, vec3 fragPos)
+{
+    return ShadeForward(material, normal, fragPos, BakedLight(vec3(0.0), dirLight.ambient, 0));
+}
@@ -0,0 +1,257 @@
+#ifndef LIGHTMAP_H
+#define LIGHTMAP_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <learnopengl/model.h>
+
+#include "light.h"
+#include "uniform_blocks.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// What lightmap_baker writes and Lightmap reads: one RGBA atlas and, for every mesh of the
+// model, the atlas coordinates (second UV set) of each of its vertices. A vertex on the seam of
+// two charts needs two coordinates: its copies follow the mesh's vertices, meshCopies names the
+// vertex each one copies and meshIndices is the mesh's index buffer using them (empty without
+// copies). A texel holds the
+// irradiance of the baked point lights in rgb (their ambient already darkened by occlusion) and
+// the ambient occlusion in a. The lights baked are the first bakedPointLights of the scene;
+// sceneHash identifies them and the model matrix (hashScene), so moving or recolouring a lamp or
+// the model makes the file stale.
+//
+// file: "LMAP", version, width, height, bakedPointLights, mesh count, the 64-bit scene hash, then
+// per mesh its coordinate count and vec2 coordinates, its copy count and uint32 copied vertices,
+// its index count and uint32 indices, then width * height RGBA half floats, row 0 first; all
+// little-endian
+struct LightmapData
+{
+    static const uint32_t VERSION = 3;
+
+    int width = 0;
+    int height = 0;
+    int bakedPointLights = 0;
+    uint64_t sceneHash = 0;
+    std::vector<std::vector<glm::vec2>> meshCoords;
+    std::vector<std::vector<uint32_t>> meshCopies;
+    std::vector<std::vector<uint32_t>> meshIndices;
+    // RGBA per texel, packed with glm::packHalf1x16
+    std::vector<uint16_t> texels;
+
+    bool write(const std::string &path) const
+    {
+        FILE *file = std::fopen(path.c_str(), "wb");
+        if (!file)
+        {
+            std::cout << "ERROR::LIGHTMAP::FILE_NOT_WRITTEN: " << path << std::endl;
+            return false;
+        }
+        uint32_t header[6] = { magic(), VERSION, (uint32_t)width, (uint32_t)height, (uint32_t)bakedPointLights,
+                               (uint32_t)meshCoords.size() };
+        bool ok = std::fwrite(header, sizeof(header), 1, file) == 1 && std::fwrite(&sceneHash, sizeof(sceneHash), 1, file) == 1;
+        for (size_t i = 0; i < meshCoords.size(); i++)
+            ok = ok && writeArray(file, meshCoords[i]) && writeArray(file, meshCopies[i]) && writeArray(file, meshIndices[i]);
+        ok = ok && std::fwrite(texels.data(), sizeof(uint16_t), texels.size(), file) == texels.size();
+        ok = std::fclose(file) == 0 && ok;
+        if (!ok)
+            std::cout << "ERROR::LIGHTMAP::FILE_NOT_WRITTEN: " << path << std::endl;
+        return ok;
+    }
+
+    // false without a message if the file does not exist (nothing was baked yet)
+    bool read(const std::string &path)
+    {
+        FILE *file = std::fopen(path.c_str(), "rb");
+        if (!file)
+            return false;
+        uint32_t header[6];
+        bool ok = std::fread(header, sizeof(header), 1, file) == 1 && header[0] == magic() && header[1] == VERSION
+                  && std::fread(&sceneHash, sizeof(sceneHash), 1, file) == 1;
+        if (ok)
+        {
+            width = (int)header[2];
+            height = (int)header[3];
+            bakedPointLights = (int)header[4];
+            meshCoords.assign(header[5], std::vector<glm::vec2>());
+            meshCopies.assign(header[5], std::vector<uint32_t>());
+            meshIndices.assign(header[5], std::vector<uint32_t>());
+        }
+        for (size_t i = 0; ok && i < meshCoords.size(); i++)
+            ok = readArray(file, meshCoords[i]) && readArray(file, meshCopies[i]) && readArray(file, meshIndices[i]);
+        if (ok)
+        {
+            texels.resize((size_t)width * height * 4);
+            ok = std::fread(texels.data(), sizeof(uint16_t), texels.size(), file) == texels.size();
+        }
+        std::fclose(file);
+        if (!ok)
+            std::cout << "ERROR::LIGHTMAP::FILE_NOT_READ: " << path << std::endl;
+        return ok;
+    }
+
+    // FNV-1a over the model matrix and every parameter of the lights that shapes the bake
+    static uint64_t hashScene(const glm::mat4 &modelMatrix, const std::vector<point_light> &lights)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        auto add = [&hash](const void *data, size_t size) {
+            const unsigned char *bytes = static_cast<const unsigned char *>(data);
+            for (size_t i = 0; i < size; i++)
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+        };
+        add(&modelMatrix, sizeof(modelMatrix));
+        for (const point_light &light : lights)
+        {
+            add(&light.position, sizeof(light.position));
+            add(&light.constant, sizeof(light.constant));
+            add(&light.linear, sizeof(light.linear));
+            add(&light.quadratic, sizeof(light.quadratic));
+            add(&light.ambient, sizeof(light.ambient));
+            add(&light.diffuse, sizeof(light.diffuse));
+            add(&light.specular, sizeof(light.specular));
+        }
+        return hash;
+    }
+
+private:
+    static uint32_t magic()
+    {
+        return 'L' | 'M' << 8 | 'A' << 16 | 'P' << 24;
+    }
+
+    // a uint32 count, then the elements
+    template <typename T>
+    static bool writeArray(FILE *file, const std::vector<T> &array)
+    {
+        uint32_t count = (uint32_t)array.size();
+        return std::fwrite(&count, sizeof(count), 1, file) == 1
+               && (count == 0 || std::fwrite(array.data(), sizeof(T), count, file) == count);
+    }
+
+    template <typename T>
+    static bool readArray(FILE *file, std::vector<T> &array)
+    {
+        uint32_t count = 0;
+        if (std::fread(&count, sizeof(count), 1, file) != 1)
+            return false;
+        array.resize(count);
+        return count == 0 || std::fread(array.data(), sizeof(T), count, file) == count;
+    }
+};
+
+// A baked lightmap on the GPU. load() gives each mesh of the model its lightmap coordinates
+// (Mesh::setLightmapCoords) and uploads the atlas; the LIGHTMAP variant of 1.model_loading
+// samples it instead of shading the baked point lights, and darkens the sun's ambient by the
+// occlusion. Specular highlights of the baked lights are dropped.
+class Lightmap
+{
+public:
+    // point lights baked into the atlas: the first ones of the LightRegistry
+    int bakedPointLights;
+
+    Lightmap()
+        : bakedPointLights(0), texture(0), width(0), height(0)
+    {
+    }
+
+    ~Lightmap()
+    {
+        if (texture != 0)
+            glDeleteTextures(1, &texture);
+    }
+
+    Lightmap(const Lightmap &) = delete;
+    Lightmap &operator=(const Lightmap &) = delete;
+
+    // reads a lightmap baked for model, placed by modelMatrix, with the scene's staticLights;
+    // false if there is none or it was baked for other meshes, another placement or other lights
+    bool load(const std::string &path, Model &model, const glm::mat4 &modelMatrix, const std::vector<point_light> &staticLights)
+    {
+        LightmapData data;
+        if (!data.read(path))
+            return false;
+        bool matches = data.meshCoords.size() == model.meshes.size() && data.bakedPointLights >= 0
+                       && data.bakedPointLights <= (int)staticLights.size();
+        if (matches)
+        {
+            std::vector<point_light> baked(staticLights.begin(), staticLights.begin() + data.bakedPointLights);
+            matches = data.sceneHash == LightmapData::hashScene(modelMatrix, baked);
+        }
+        for (size_t i = 0; matches && i < model.meshes.size(); i++)
+            matches = fits(data, i, model.meshes[i]);
+        if (!matches)
+        {
+            std::cout << "ERROR::LIGHTMAP::STALE: " << path << " was baked for other meshes, lights or placement, bake it again" << std::endl;
+            return false;
+        }
+
+        for (size_t i = 0; i < model.meshes.size(); i++)
+            model.meshes[i].setLightmapCoords(data.meshCoords[i], data.meshCopies[i], data.meshIndices[i]);
+
+        if (texture == 0)
+            glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, data.width, data.height, 0, GL_RGBA, GL_HALF_FLOAT, data.texels.data());
+        // the charts are padded by a few texels, not enough for mipmaps
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        width = data.width;
+        height = data.height;
+        bakedPointLights = data.bakedPointLights;
+        return true;
+    }
+
+    bool loaded() const
+    {
+        return texture != 0;
+    }
+
+    void bind() const
+    {
+        glActiveTexture(GL_TEXTURE0 + LIGHTMAP_UNIT);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    size_t gpuBytes() const
+    {
+        // RGBA half floats
+        return (size_t)width * height * 8;
+    }
+
+private:
+    GLuint texture;
+    int width, height;
+
+    // whether mesh i of data was baked for mesh: a coordinate per loaded vertex and copy, copies
+    // of loaded vertices, and as many indices, all of them in range. A mesh split by an earlier
+    // load no longer has its loaded indices, so it needs new ones
+    static bool fits(const LightmapData &data, size_t i, const Mesh &mesh)
+    {
+        size_t loaded = mesh.vertexCount - mesh.lightmapCopyCount;
+        const std::vector<uint32_t> &copies = data.meshCopies[i];
+        const std::vector<uint32_t> &indices = data.meshIndices[i];
+        bool replacesIndices = !copies.empty() || !indices.empty() || mesh.lightmapCopyCount > 0;
+        if (data.meshCoords[i].size() != loaded + copies.size() || (replacesIndices && indices.size() != mesh.indexCount))
+            return false;
+        for (uint32_t vertex : copies)
+            if (vertex >= loaded)
+                return false;
+        for (uint32_t index : indices)
+            if (index >= data.meshCoords[i].size())
+                return false;
+        return true;
+    }
+};
+
+#endif
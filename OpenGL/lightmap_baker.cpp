@@ -0,0 +1,135 @@
+// Offline lightmap baker: builds the main.cpp Scene on the no-op GL of learnopengl/mock_gl.h (no
+// EGL, GPU or display), so de_dust2 is loaded through Model exactly as the renderer loads it,
+// and bakes the scene's static point lights and ambient occlusion on every core of the CPU
+// (lightmap_baker.h). The result is written to resources/de_dust2/de_dust2.lightmap, where
+// Scene picks it up at the next start.
+//
+// usage: lightmap_baker [--data DIR] [--output FILE] [--texels-per-unit N] [--max-size N]
+//                       [--ao-rays N] [--ao-distance D] [--bias D] [--threads N]
+//
+// --data is the directory with the shaders and resources, like bench's; --output is relative
+// to it. --texels-per-unit sets the lightmap density in world units (lowered if the charts do
+// not fit into --max-size); --ao-rays and --ao-distance set the occlusion rays per texel and
+// their length; --bias how far off the surface rays start; --threads 0 uses every core.
+
+#include <glad/glad.h>
+
+#include "scene.h"
+#include "lightmap_baker.h"
+
+#include <learnopengl/mock_gl.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+#ifndef OPENGL_DATA_DIR
+#define OPENGL_DATA_DIR "."
+#endif
+
+struct BakerOptions
+{
+    std::string dataDir = OPENGL_DATA_DIR;
+    std::string outputPath = DUST2_LIGHTMAP_PATH;
+    LightmapBaker baker;
+};
+
+static void printUsage()
+{
+    std::cerr << "usage: lightmap_baker [--data DIR] [--output FILE] [--texels-per-unit N] [--max-size N]"
+                 " [--ao-rays N] [--ao-distance D] [--bias D] [--threads N]" << std::endl;
+}
+
+static bool parseOptions(int argc, char **argv, BakerOptions &options)
+{
+    LightmapBaker &baker = options.baker;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            printUsage();
+            return false;
+        }
+        const char *value = argv[++i];
+        if (arg == "--data")
+            options.dataDir = value;
+        else if (arg == "--output")
+            options.outputPath = value;
+        else if (arg == "--texels-per-unit")
+            baker.texelsPerUnit = static_cast<float>(std::atof(value));
+        else if (arg == "--max-size")
+            baker.maxSize = std::atoi(value);
+        else if (arg == "--ao-rays")
+            baker.aoRays = std::atoi(value);
+        else if (arg == "--ao-distance")
+            baker.aoDistance = static_cast<float>(std::atof(value));
+        else if (arg == "--bias")
+            baker.bias = static_cast<float>(std::atof(value));
+        else if (arg == "--threads")
+            baker.threads = std::atoi(value);
+        else
+        {
+            printUsage();
+            return false;
+        }
+    }
+    if (baker.texelsPerUnit <= 0.0f || baker.maxSize < 64 || baker.aoRays < 1 || baker.aoDistance <= 0.0f
+        || baker.bias < 0.0f || baker.threads < 0)
+    {
+        printUsage();
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    BakerOptions options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    // shaders and resources are looked up relative to the working directory, like main.cpp
+    if (chdir(options.dataDir.c_str()) != 0)
+    {
+        std::cerr << "Cannot change directory to " << options.dataDir << std::endl;
+        return 1;
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc)mockgl::getProcAddress))
+    {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return 1;
+    }
+    // the mock's programs are not worth caching
+    ProgramCache::enabled() = false;
+
+    // the geometry stays in RAM for the baker
+    Scene *scene = new Scene(true);
+    const Model &model = scene->staticModel();
+    if (model.meshes.empty())
+    {
+        std::cerr << "de_dust2 has no meshes, nothing to bake" << std::endl;
+        delete scene;
+        return 1;
+    }
+
+    LightmapBaker &baker = options.baker;
+    LightmapData data = baker.bake(model, scene->staticModelMatrix(), scene->staticPointLights());
+    delete scene;
+    if (data.width == 0)
+        return 1;
+
+    std::cout << "Baked " << data.bakedPointLights << " point lights and ambient occlusion: "
+              << baker.triangles << " triangles, " << baker.charts << " charts, "
+              << baker.copiedVertices << " vertices split at seams, " << baker.bvhNodes << " BVH nodes, "
+              << data.width << " x " << data.height << " texels (" << baker.litTexels << " lit) at "
+              << baker.bakedTexelsPerUnit << " per unit; charts " << baker.chartMs << " ms, tracing "
+              << baker.traceMs << " ms" << std::endl;
+    if (!data.write(options.outputPath))
+        return 1;
+    std::cout << "Wrote " << options.outputPath << std::endl;
+    return 0;
+}
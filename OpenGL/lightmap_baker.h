@@ -0,0 +1,564 @@
+#ifndef LIGHTMAP_BAKER_H
+#define LIGHTMAP_BAKER_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <learnopengl/model.h>
+
+#include "light.h"
+#include "lightmap.h"
+#include "triangle_bvh.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Bakes a model's static lighting into a lightmap on the CPU (see lightmap_baker.cpp):
+// 1. charts: the triangles of each mesh are grouped into charts of neighbours (sharing a vertex
+//    or an edge) facing the same side of the same axis, so a chart never folds onto itself.
+//    Each chart is projected onto the plane of its axis. A vertex gets one coordinate, so one
+//    shared by several charts is copied for every chart but the first;
+// 2. the charts are sized by texelsPerUnit, padded, and packed into rows of a square atlas. If
+//    they do not fit into maxSize, the density is lowered until they do;
+// 3. every texel a triangle covers gets the world position and normal under its center;
+// 4. for every such texel, on all cores: ambient occlusion from aoRays cosine-weighted rays up
+//    to aoDistance, and the irradiance of each light, with a shadow ray, as CalcPointLight
+//    shades it minus the specular term;
+// 5. the charts' padding is filled from the texels next to it, so bilinear filtering never
+//    reads an empty texel.
+class LightmapBaker
+{
+public:
+    // settings
+    float texelsPerUnit; // world units are those of the model matrix
+    int maxSize;         // width and height limit of the atlas
+    int padding;         // texels around every chart
+    int aoRays;          // rounded to a square number, stratified
+    float aoDistance;    // occluders further away do not darken
+    float bias;          // rays start this far off the surface
+    int threads;         // 0: every core
+
+    // results of the last bake()
+    size_t triangles;
+    size_t charts;
+    size_t copiedVertices; // split off at chart seams
+    size_t bvhNodes;
+    size_t litTexels;
+    float bakedTexelsPerUnit;
+    double chartMs, traceMs;
+
+    LightmapBaker()
+        : texelsPerUnit(4.0f), maxSize(4096), padding(2), aoRays(64), aoDistance(2.0f), bias(0.01f), threads(0),
+          triangles(0), charts(0), copiedVertices(0), bvhNodes(0), litTexels(0), bakedTexelsPerUnit(0.0f), chartMs(0.0), traceMs(0.0)
+    {
+    }
+
+    // the meshes of model need their vertices and indices (keepGeometry); lights are baked in order
+    LightmapData bake(const Model &model, const glm::mat4 &modelMatrix, const std::vector<point_light> &lights)
+    {
+        auto start = std::chrono::steady_clock::now();
+        LightmapData data;
+        copiedVertices = 0;
+        data.bakedPointLights = (int)lights.size();
+        data.sceneHash = LightmapData::hashScene(modelMatrix, lights);
+
+        // world-space geometry
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(modelMatrix)));
+        std::vector<MeshGeometry> meshes(model.meshes.size());
+        std::vector<TriangleBvh::Triangle> soup;
+        for (size_t m = 0; m < model.meshes.size(); m++)
+        {
+            const Mesh &mesh = model.meshes[m];
+            MeshGeometry &geometry = meshes[m];
+            for (const Vertex &vertex : mesh.vertices)
+            {
+                geometry.positions.push_back(glm::vec3(modelMatrix * glm::vec4(vertex.Position, 1.0f)));
+                glm::vec3 normal = normalMatrix * vertex.Normal;
+                float length = glm::length(normal);
+                geometry.normals.push_back(length > 0.0f ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f));
+            }
+            geometry.indices = mesh.indices;
+            if (mesh.vertices.empty() && mesh.vertexCount > 0)
+                std::cout << "ERROR::LIGHTMAP_BAKER::NO_GEOMETRY: mesh " << m << " was released after upload" << std::endl;
+            for (size_t i = 0; i + 2 < geometry.indices.size(); i += 3)
+                soup.push_back({ geometry.positions[geometry.indices[i]], geometry.positions[geometry.indices[i + 1]],
+                                 geometry.positions[geometry.indices[i + 2]] });
+        }
+        triangles = soup.size();
+
+        std::vector<Chart> allCharts;
+        for (size_t m = 0; m < meshes.size(); m++)
+        {
+            buildCharts(meshes[m], (unsigned int)m, allCharts);
+            copiedVertices += meshes[m].copies.size();
+        }
+        charts = allCharts.size();
+
+        int size = pack(allCharts);
+        if (size == 0)
+        {
+            std::cout << "ERROR::LIGHTMAP_BAKER::CHARTS_DO_NOT_FIT: " << charts << " charts need more than " << maxSize
+                      << " x " << maxSize << " texels at any density" << std::endl;
+            chartMs = millisecondsSince(start);
+            return data;
+        }
+        data.width = data.height = size;
+        data.meshCoords.resize(meshes.size());
+        data.meshCopies.resize(meshes.size());
+        data.meshIndices.resize(meshes.size());
+        for (size_t m = 0; m < meshes.size(); m++)
+        {
+            data.meshCoords[m].assign(meshes[m].positions.size(), glm::vec2(0.0f));
+            data.meshCopies[m] = meshes[m].copies;
+            if (!meshes[m].copies.empty())
+                data.meshIndices[m] = meshes[m].indices;
+        }
+        for (const Chart &chart : allCharts)
+        {
+            const MeshGeometry &geometry = meshes[chart.mesh];
+            for (unsigned int vertex : chart.vertices)
+            {
+                glm::vec2 texel = chart.origin + (project(geometry.positions[vertex], chart.axis) - chart.projectedMin) * bakedTexelsPerUnit;
+                data.meshCoords[chart.mesh][vertex] = texel / (float)size;
+            }
+        }
+
+        std::vector<Sample> samples((size_t)size * size);
+        for (size_t m = 0; m < meshes.size(); m++)
+            rasterize(meshes[m], data.meshCoords[m], size, samples);
+        chartMs = millisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        TriangleBvh bvh(std::move(soup));
+        bvhNodes = bvh.nodeCount();
+        std::vector<glm::vec4> texels((size_t)size * size, glm::vec4(0.0f));
+        trace(bvh, lights, size, samples, texels);
+        dilate(size, samples, texels);
+        traceMs = millisecondsSince(start);
+
+        data.texels.resize(texels.size() * 4);
+        for (size_t i = 0; i < texels.size(); i++)
+            for (int c = 0; c < 4; c++)
+                data.texels[i * 4 + c] = glm::packHalf1x16(texels[i][c]);
+        return data;
+    }
+
+private:
+    struct MeshGeometry
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+        std::vector<unsigned int> indices;
+        // for the vertices buildCharts() appended, the one each copies
+        std::vector<unsigned int> copies;
+    };
+
+    struct Chart
+    {
+        unsigned int mesh = 0;
+        int axis = 0; // projected along: 0 x, 1 y, 2 z
+        std::vector<unsigned int> vertices;
+        glm::vec2 projectedMin = glm::vec2(0.0f), projectedMax = glm::vec2(0.0f);
+        // texel size, padding included, and the corner of its contents in the atlas
+        glm::ivec2 size = glm::ivec2(0);
+        glm::vec2 origin = glm::vec2(0.0f);
+    };
+
+    // what lies under a texel center
+    struct Sample
+    {
+        glm::vec3 position;
+        glm::vec3 normal;     // interpolated, as the shader sees it
+        glm::vec3 faceNormal; // rays start off this side of the triangle
+        bool covered = false;
+    };
+
+    static double millisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static glm::vec2 project(const glm::vec3 &position, int axis)
+    {
+        return glm::vec2(position[(axis + 1) % 3], position[(axis + 2) % 3]);
+    }
+
+    static unsigned int findRoot(std::vector<unsigned int> &parents, unsigned int i)
+    {
+        while (parents[i] != i)
+        {
+            parents[i] = parents[parents[i]];
+            i = parents[i];
+        }
+        return i;
+    }
+
+    void buildCharts(MeshGeometry &geometry, unsigned int mesh, std::vector<Chart> &out) const
+    {
+        size_t triangleCount = geometry.indices.size() / 3;
+        if (triangleCount == 0)
+            return;
+
+        // dominant axis and facing of every triangle, 0..5
+        std::vector<int> facing(triangleCount);
+        std::vector<float> areas(triangleCount);
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            const glm::vec3 &a = geometry.positions[geometry.indices[t * 3]];
+            glm::vec3 normal = glm::cross(geometry.positions[geometry.indices[t * 3 + 1]] - a, geometry.positions[geometry.indices[t * 3 + 2]] - a);
+            glm::vec3 size = glm::abs(normal);
+            int axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+            facing[t] = axis * 2 + (normal[axis] < 0.0f ? 1 : 0);
+            areas[t] = glm::length(normal) * 0.5f;
+        }
+
+        std::vector<unsigned int> parents(triangleCount);
+        std::iota(parents.begin(), parents.end(), 0u);
+        auto join = [&](unsigned int a, unsigned int b) {
+            a = findRoot(parents, a);
+            b = findRoot(parents, b);
+            if (a != b)
+                parents[std::max(a, b)] = std::min(a, b);
+        };
+
+        // the triangles sharing a vertex and a facing share a chart
+        std::vector<unsigned int> vertexTriangle(geometry.positions.size() * 6, UINT32_MAX);
+        for (size_t i = 0; i < geometry.indices.size(); i++)
+        {
+            unsigned int t = (unsigned int)(i / 3);
+            unsigned int &first = vertexTriangle[geometry.indices[i] * 6 + facing[t]];
+            if (first == UINT32_MAX)
+                first = t;
+            else
+                join(first, t);
+        }
+
+        // triangles with their own vertices still share edges by position: weld them to a 1e-3 grid,
+        // 21 bits per axis
+        std::unordered_map<uint64_t, unsigned int> welded;
+        std::vector<unsigned int> weldedIds(geometry.positions.size());
+        for (size_t v = 0; v < geometry.positions.size(); v++)
+        {
+            glm::ivec3 cell = glm::ivec3(glm::round(geometry.positions[v] * 1e3f)) + glm::ivec3(1 << 20);
+            uint64_t key = (uint64_t)(cell.x & 0x1FFFFF) | (uint64_t)(cell.y & 0x1FFFFF) << 21 | (uint64_t)(cell.z & 0x1FFFFF) << 42;
+            auto found = welded.emplace(key, (unsigned int)welded.size());
+            weldedIds[v] = found.first->second;
+        }
+        std::unordered_map<uint64_t, unsigned int> edges;
+        for (size_t t = 0; t < triangleCount; t++)
+            for (int e = 0; e < 3; e++)
+            {
+                uint64_t a = weldedIds[geometry.indices[t * 3 + e]];
+                uint64_t b = weldedIds[geometry.indices[t * 3 + (e + 1) % 3]];
+                uint64_t key = std::min(a, b) << 32 | std::max(a, b);
+                auto found = edges.emplace(key, (unsigned int)t);
+                if (!found.second && facing[found.first->second] == facing[t])
+                    join(found.first->second, (unsigned int)t);
+            }
+
+        // one chart per root, along the axis most of its area faces
+        std::unordered_map<unsigned int, size_t> chartOf;
+        std::vector<glm::vec3> axisAreas;
+        size_t firstChart = out.size();
+        std::vector<unsigned int> triangleChart(triangleCount);
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            unsigned int root = findRoot(parents, (unsigned int)t);
+            auto found = chartOf.emplace(root, out.size());
+            if (found.second)
+            {
+                Chart chart;
+                chart.mesh = mesh;
+                out.push_back(chart);
+                axisAreas.push_back(glm::vec3(0.0f));
+            }
+            triangleChart[t] = (unsigned int)found.first->second;
+            axisAreas[found.first->second - firstChart][facing[t] / 2] += areas[t];
+        }
+        for (size_t c = firstChart; c < out.size(); c++)
+        {
+            const glm::vec3 &area = axisAreas[c - firstChart];
+            out[c].axis = area.x > area.y ? (area.x > area.z ? 0 : 2) : (area.y > area.z ? 1 : 2);
+        }
+        // a vertex belongs to the chart of the first triangle using it; every other chart using it
+        // gets a copy, and its triangles' indices are moved to the copy
+        std::vector<unsigned int> vertexChart(geometry.positions.size(), UINT32_MAX);
+        std::unordered_map<uint64_t, unsigned int> copyOf;
+        for (size_t i = 0; i < geometry.indices.size(); i++)
+        {
+            unsigned int vertex = geometry.indices[i];
+            unsigned int chart = triangleChart[i / 3];
+            if (vertexChart[vertex] == UINT32_MAX)
+            {
+                vertexChart[vertex] = chart;
+                addVertex(geometry, out[chart], vertex);
+            }
+            else if (vertexChart[vertex] != chart)
+            {
+                auto found = copyOf.emplace((uint64_t)vertex << 32 | chart, (unsigned int)geometry.positions.size());
+                if (found.second)
+                {
+                    geometry.positions.push_back(geometry.positions[vertex]);
+                    geometry.normals.push_back(geometry.normals[vertex]);
+                    geometry.copies.push_back(vertex);
+                    addVertex(geometry, out[chart], found.first->second);
+                }
+                geometry.indices[i] = found.first->second;
+            }
+        }
+    }
+
+    static void addVertex(const MeshGeometry &geometry, Chart &chart, unsigned int vertex)
+    {
+        glm::vec2 projected = project(geometry.positions[vertex], chart.axis);
+        if (chart.vertices.empty())
+            chart.projectedMin = chart.projectedMax = projected;
+        chart.projectedMin = glm::min(chart.projectedMin, projected);
+        chart.projectedMax = glm::max(chart.projectedMax, projected);
+        chart.vertices.push_back(vertex);
+    }
+
+    // places the charts in rows of the smallest power-of-two square that holds them at
+    // texelsPerUnit, lowering the density while they do not fit into maxSize; returns the size,
+    // or 0 if they do not fit even once the density no longer shrinks any chart (every chart
+    // keeps its padding and at least one texel)
+    int pack(std::vector<Chart> &charts)
+    {
+        std::vector<size_t> order(charts.size());
+        std::iota(order.begin(), order.end(), (size_t)0);
+        double previousArea = INFINITY;
+        for (float density = texelsPerUnit;; density *= 0.8f)
+        {
+            double area = 0.0;
+            for (Chart &chart : charts)
+            {
+                glm::vec2 extent = (chart.projectedMax - chart.projectedMin) * density;
+                chart.size = glm::ivec2(glm::ceil(extent)) + glm::ivec2(1 + 2 * padding);
+                area += (double)chart.size.x * chart.size.y;
+            }
+            if (area >= previousArea)
+                return 0;
+            previousArea = area;
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return charts[a].size.y > charts[b].size.y; });
+
+            int size = 64;
+            while (size < maxSize && (double)size * size < area)
+                size *= 2;
+            for (; size <= maxSize; size *= 2)
+            {
+                int x = 0, y = 0, rowHeight = 0;
+                bool fits = true;
+                for (size_t i : order)
+                {
+                    Chart &chart = charts[i];
+                    if (x + chart.size.x > size)
+                    {
+                        x = 0;
+                        y += rowHeight;
+                        rowHeight = 0;
+                    }
+                    if (chart.size.x > size || y + chart.size.y > size)
+                    {
+                        fits = false;
+                        break;
+                    }
+                    chart.origin = glm::vec2(x + padding, y + padding);
+                    x += chart.size.x;
+                    rowHeight = std::max(rowHeight, chart.size.y);
+                }
+                if (fits)
+                {
+                    bakedTexelsPerUnit = density;
+                    if (density < texelsPerUnit)
+                        std::cout << "LIGHTMAP_BAKER: lowered the density to " << density << " texels per unit to fit "
+                                  << maxSize << " x " << maxSize << std::endl;
+                    return size;
+                }
+            }
+        }
+    }
+
+    // the position and normal under every texel center the mesh's triangles cover; a triangle
+    // too small to cover a center takes the texel under its centroid
+    static void rasterize(const MeshGeometry &geometry, const std::vector<glm::vec2> &coords, int size, std::vector<Sample> &samples)
+    {
+        for (size_t t = 0; t + 2 < geometry.indices.size(); t += 3)
+        {
+            unsigned int v[3] = { geometry.indices[t], geometry.indices[t + 1], geometry.indices[t + 2] };
+            glm::vec2 p[3];
+            for (int i = 0; i < 3; i++)
+                p[i] = coords[v[i]] * (float)size;
+            glm::vec3 faceNormal = glm::cross(geometry.positions[v[1]] - geometry.positions[v[0]], geometry.positions[v[2]] - geometry.positions[v[0]]);
+            float faceLength = glm::length(faceNormal);
+            if (faceLength == 0.0f)
+                continue;
+            faceNormal /= faceLength;
+
+            auto write = [&](int x, int y, const glm::vec3 &weights) {
+                Sample &sample = samples[(size_t)y * size + x];
+                sample.position = weights.x * geometry.positions[v[0]] + weights.y * geometry.positions[v[1]] + weights.z * geometry.positions[v[2]];
+                glm::vec3 normal = weights.x * geometry.normals[v[0]] + weights.y * geometry.normals[v[1]] + weights.z * geometry.normals[v[2]];
+                sample.normal = glm::length(normal) > 0.0f ? glm::normalize(normal) : faceNormal;
+                sample.faceNormal = glm::dot(faceNormal, sample.normal) < 0.0f ? -faceNormal : faceNormal;
+                sample.covered = true;
+            };
+
+            float doubleArea = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y);
+            bool wrote = false;
+            if (doubleArea != 0.0f)
+            {
+                glm::vec2 low = glm::min(p[0], glm::min(p[1], p[2]));
+                glm::vec2 high = glm::max(p[0], glm::max(p[1], p[2]));
+                int x0 = std::max(0, (int)std::floor(low.x)), x1 = std::min(size - 1, (int)std::ceil(high.x));
+                int y0 = std::max(0, (int)std::floor(low.y)), y1 = std::min(size - 1, (int)std::ceil(high.y));
+                for (int y = y0; y <= y1; y++)
+                    for (int x = x0; x <= x1; x++)
+                    {
+                        glm::vec2 center(x + 0.5f, y + 0.5f);
+                        glm::vec3 weights;
+                        weights.x = ((p[1].x - center.x) * (p[2].y - center.y) - (p[2].x - center.x) * (p[1].y - center.y)) / doubleArea;
+                        weights.y = ((p[2].x - center.x) * (p[0].y - center.y) - (p[0].x - center.x) * (p[2].y - center.y)) / doubleArea;
+                        weights.z = 1.0f - weights.x - weights.y;
+                        if (weights.x < 0.0f || weights.y < 0.0f || weights.z < 0.0f)
+                            continue;
+                        write(x, y, weights);
+                        wrote = true;
+                    }
+            }
+            if (!wrote)
+            {
+                glm::ivec2 texel = glm::clamp(glm::ivec2((p[0] + p[1] + p[2]) / 3.0f), glm::ivec2(0), glm::ivec2(size - 1));
+                if (!samples[(size_t)texel.y * size + texel.x].covered)
+                    write(texel.x, texel.y, glm::vec3(1.0f / 3.0f));
+            }
+        }
+    }
+
+    void trace(const TriangleBvh &bvh, const std::vector<point_light> &lights, int size, const std::vector<Sample> &samples,
+               std::vector<glm::vec4> &texels)
+    {
+        std::vector<float> ranges;
+        for (const point_light &light : lights)
+            ranges.push_back(light.range());
+        int strata = std::max(1, (int)std::lround(std::sqrt((float)aoRays)));
+
+        std::atomic<int> nextRow(0);
+        std::atomic<size_t> lit(0);
+        auto work = [&]() {
+            size_t rowLit = 0;
+            for (int y = nextRow++; y < size; y = nextRow++)
+                for (int x = 0; x < size; x++)
+                {
+                    const Sample &sample = samples[(size_t)y * size + x];
+                    if (!sample.covered)
+                        continue;
+                    glm::vec3 origin = sample.position + sample.faceNormal * bias;
+
+                    // cosine-weighted hemisphere around the normal, one jittered ray per stratum
+                    glm::vec3 tangent = glm::normalize(glm::cross(std::abs(sample.normal.x) > 0.9f ? glm::vec3(0.0f, 1.0f, 0.0f)
+                                                                                                   : glm::vec3(1.0f, 0.0f, 0.0f),
+                                                                  sample.normal));
+                    glm::vec3 bitangent = glm::cross(sample.normal, tangent);
+                    uint32_t random = (uint32_t)(y * size + x) * 2654435761u + 1u;
+                    int hits = 0;
+                    for (int i = 0; i < strata; i++)
+                        for (int j = 0; j < strata; j++)
+                        {
+                            float u = (i + nextRandom(random)) / strata;
+                            float v = (j + nextRandom(random)) / strata;
+                            float radius = std::sqrt(u);
+                            float angle = 6.2831853f * v;
+                            glm::vec3 direction = tangent * (radius * std::cos(angle)) + bitangent * (radius * std::sin(angle)) +
+                                                  sample.normal * std::sqrt(std::max(0.0f, 1.0f - u));
+                            if (bvh.occluded(origin, direction, aoDistance))
+                                hits++;
+                        }
+                    float occlusion = 1.0f - hits / (float)(strata * strata);
+
+                    glm::vec3 irradiance(0.0f);
+                    for (size_t l = 0; l < lights.size(); l++)
+                    {
+                        const point_light &light = lights[l];
+                        glm::vec3 toLight = light.position - sample.position;
+                        float distance = glm::length(toLight);
+                        if (distance >= ranges[l] || distance == 0.0f)
+                            continue;
+                        glm::vec3 direction = toLight / distance;
+                        float attenuation = 1.0f / (light.constant + light.linear * distance + light.quadratic * distance * distance);
+                        glm::vec3 received = light.ambient * occlusion;
+                        float diff = std::max(glm::dot(sample.normal, direction), 0.0f);
+                        glm::vec3 shadowRay = light.position - origin;
+                        if (diff > 0.0f && !bvh.occluded(origin, glm::normalize(shadowRay), glm::length(shadowRay)))
+                            received += light.diffuse * diff;
+                        irradiance += received * attenuation;
+                    }
+                    texels[(size_t)y * size + x] = glm::vec4(irradiance, occlusion);
+                    rowLit++;
+                }
+            lit += rowLit;
+        };
+
+        int threadCount = threads > 0 ? threads : std::max(1, (int)std::thread::hardware_concurrency());
+        std::vector<std::thread> workers;
+        for (int i = 1; i < threadCount; i++)
+            workers.emplace_back(work);
+        work();
+        for (std::thread &worker : workers)
+            worker.join();
+        litTexels = lit;
+    }
+
+    // spreads the texels into the padding around them, one ring per pass
+    void dilate(int size, std::vector<Sample> &samples, std::vector<glm::vec4> &texels) const
+    {
+        std::vector<char> filled(samples.size());
+        for (size_t i = 0; i < samples.size(); i++)
+            filled[i] = samples[i].covered;
+        for (int pass = 0; pass < padding + 1; pass++)
+        {
+            std::vector<char> next = filled;
+            for (int y = 0; y < size; y++)
+                for (int x = 0; x < size; x++)
+                {
+                    if (filled[(size_t)y * size + x])
+                        continue;
+                    glm::vec4 sum(0.0f);
+                    int count = 0;
+                    for (int dy = -1; dy <= 1; dy++)
+                        for (int dx = -1; dx <= 1; dx++)
+                        {
+                            int nx = x + dx, ny = y + dy;
+                            if (nx < 0 || ny < 0 || nx >= size || ny >= size || !filled[(size_t)ny * size + nx])
+                                continue;
+                            sum += texels[(size_t)ny * size + nx];
+                            count++;
+                        }
+                    if (count > 0)
+                    {
+                        texels[(size_t)y * size + x] = sum / (float)count;
+                        next[(size_t)y * size + x] = 1;
+                    }
+                }
+            filled.swap(next);
+        }
+    }
+
+    // xorshift, uniform in [0, 1)
+    static float nextRandom(uint32_t &state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (state >> 8) * (1.0f / 16777216.0f);
+    }
+};
+
+#endif
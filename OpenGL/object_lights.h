@@ -0,0 +1,158 @@
+#ifndef OBJECT_LIGHTS_H
+#define OBJECT_LIGHTS_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/storage_buffer.h>
+
+#include "light_registry.h"
+#include "uniform_blocks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Per-object light lists built on the CPU, for the forward shaders without clustering. Every
+// light reaches only as far as its range (light_range: the distance where it falls below
+// LIGHT_CUTOFF), a spotlight also only within its cone (spotlight::coneCos). Each frame the
+// world-space bounding box of every draw (a mesh, a container, the flag) is tested against
+// every light, and the indices of the lights that can reach it are appended to one array in
+// the ObjectLightIndices storage buffer. A draw passes its (first index, point lights,
+// spotlights) in the objectLights uniform, and the shader only loops over those lights.
+class ObjectLights
+{
+public:
+    // draws assigned and light indices written by the last upload()
+    int draws;
+    size_t assignedLights;
+
+    ObjectLights()
+        : draws(0), assignedLights(0),
+          indexBuffer(OBJECT_LIGHT_INDICES_BINDING)
+    {
+    }
+
+    ObjectLights(const ObjectLights &) = delete;
+    ObjectLights &operator=(const ObjectLights &) = delete;
+
+    // starts a frame: takes the bounding volumes of every light and empties the lists
+    void begin(const LightRegistry &lights)
+    {
+        points.clear();
+        spots.clear();
+        indices.clear();
+        pendingDraws = 0;
+
+        for (int i = 0; i < lights.pointLightCount(); i++)
+        {
+            const point_light &light = lights.pointLight(i);
+            float range = light.range();
+            if (range > 0.0f)
+                points.push_back({ light.position, range, (unsigned int)i });
+        }
+        for (int i = 0; i < lights.spotlightCount(); i++)
+        {
+            const spotlight &light = lights.spotLight(i);
+            float range = light.range();
+            if (range <= 0.0f)
+                continue;
+            float coneCos = light.coneCos();
+            float coneSin = std::sqrt(std::max(0.0f, 1.0f - coneCos * coneCos));
+            spots.push_back({ light.position, range, glm::normalize(light.direction), coneCos, coneSin, (unsigned int)i });
+        }
+    }
+
+    // appends the lights that can reach the world-space box [boxMin, boxMax] and returns the
+    // draw's objectLights value: first index, point lights, spotlights
+    glm::ivec3 assign(const glm::vec3 &boxMin, const glm::vec3 &boxMax)
+    {
+        glm::ivec3 list((int)indices.size(), 0, 0);
+        for (const PointBounds &light : points)
+            if (sphereTouchesBox(light.position, light.range, boxMin, boxMax))
+            {
+                indices.push_back(light.index);
+                list.y++;
+            }
+
+        glm::vec3 center = (boxMin + boxMax) * 0.5f;
+        float radius = glm::length(boxMax - center);
+        for (const SpotBounds &light : spots)
+            if (sphereTouchesBox(light.position, light.range, boxMin, boxMax) && coneTouchesSphere(light, center, radius))
+            {
+                indices.push_back(light.index);
+                list.z++;
+            }
+        pendingDraws++;
+        return list;
+    }
+
+    // the same for a model-space box drawn with the model matrix
+    glm::ivec3 assign(const glm::vec3 &boxMin, const glm::vec3 &boxMax, const glm::mat4 &model)
+    {
+        // the world box around the transformed box: center moved, half extents through |model|
+        glm::vec3 center = glm::vec3(model * glm::vec4((boxMin + boxMax) * 0.5f, 1.0f));
+        glm::vec3 extent = (boxMax - boxMin) * 0.5f;
+        glm::vec3 worldExtent(0.0f);
+        for (int axis = 0; axis < 3; axis++)
+            worldExtent += glm::abs(glm::vec3(model[axis])) * extent[axis];
+        return assign(center - worldExtent, center + worldExtent);
+    }
+
+    // writes the lists of every draw assigned since begin() to the storage buffer
+    void upload()
+    {
+        indexBuffer.upload(indices);
+        draws = pendingDraws;
+        assignedLights = indices.size();
+    }
+
+    size_t gpuBytes() const
+    {
+        return indexBuffer.gpuBytes();
+    }
+
+private:
+    struct PointBounds
+    {
+        glm::vec3 position;
+        float range;
+        unsigned int index;
+    };
+
+    struct SpotBounds
+    {
+        glm::vec3 position;
+        float range;
+        glm::vec3 direction;
+        float coneCos, coneSin;
+        unsigned int index;
+    };
+
+    std::vector<PointBounds> points;
+    std::vector<SpotBounds> spots;
+    // reused every frame to avoid reallocating
+    std::vector<GLuint> indices;
+    int pendingDraws = 0;
+
+    StorageBuffer<GLuint> indexBuffer;
+
+    static bool sphereTouchesBox(const glm::vec3 &center, float radius, const glm::vec3 &boxMin, const glm::vec3 &boxMax)
+    {
+        glm::vec3 closest = glm::clamp(center, boxMin, boxMax);
+        glm::vec3 offset = center - closest;
+        return glm::dot(offset, offset) <= radius * radius;
+    }
+
+    // whether the sphere reaches into the spotlight's cone, cut off at its range
+    static bool coneTouchesSphere(const SpotBounds &light, const glm::vec3 &center, float radius)
+    {
+        glm::vec3 v = center - light.position;
+        float along = glm::dot(v, light.direction);
+        float across = std::sqrt(std::max(0.0f, glm::dot(v, v) - along * along));
+        // distance from the sphere's center to the cone's surface, negative inside
+        float toSurface = light.coneCos * across - along * light.coneSin;
+        return toSurface <= radius && along <= light.range + radius && along >= -radius;
+    }
+};
+
+#endif
@@ -0,0 +1,137 @@
+// Offline irradiance probe baker: like lightmap_baker, builds the main.cpp Scene on the no-op GL
+// of learnopengl/mock_gl.h and bakes on every core of the CPU, here a grid of spherical harmonics
+// probes over de_dust2 (probe_baker.h) that lights the containers, the car and the flag. The
+// result is written to resources/de_dust2/de_dust2.probes, where Scene picks it up at the next
+// start.
+//
+// usage: probe_baker [--data DIR] [--output FILE] [--spacing D] [--max-probes N] [--rays N]
+//                    [--albedo A] [--bias D] [--threads N]
+//
+// --data is the directory with the shaders and resources, like bench's; --output is relative
+// to it. --spacing sets the world distance between probes (raised if the grid would hold more
+// than --max-probes); --rays the directions traced per probe; --albedo the colour of meshes
+// without a diffuse texture; --bias how far off the surface shadow rays start; --threads 0
+// uses every core.
+
+#include <glad/glad.h>
+
+#include "scene.h"
+#include "probe_baker.h"
+
+#include <learnopengl/mock_gl.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+#ifndef OPENGL_DATA_DIR
+#define OPENGL_DATA_DIR "."
+#endif
+
+struct BakerOptions
+{
+    std::string dataDir = OPENGL_DATA_DIR;
+    std::string outputPath = DUST2_PROBES_PATH;
+    ProbeBaker baker;
+};
+
+static void printUsage()
+{
+    std::cerr << "usage: probe_baker [--data DIR] [--output FILE] [--spacing D] [--max-probes N] [--rays N]"
+                 " [--albedo A] [--bias D] [--threads N]" << std::endl;
+}
+
+static bool parseOptions(int argc, char **argv, BakerOptions &options)
+{
+    ProbeBaker &baker = options.baker;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            printUsage();
+            return false;
+        }
+        const char *value = argv[++i];
+        if (arg == "--data")
+            options.dataDir = value;
+        else if (arg == "--output")
+            options.outputPath = value;
+        else if (arg == "--spacing")
+            baker.spacing = static_cast<float>(std::atof(value));
+        else if (arg == "--max-probes")
+            baker.maxProbes = static_cast<size_t>(std::atol(value));
+        else if (arg == "--rays")
+            baker.rays = std::atoi(value);
+        else if (arg == "--albedo")
+            baker.albedo = static_cast<float>(std::atof(value));
+        else if (arg == "--bias")
+            baker.bias = static_cast<float>(std::atof(value));
+        else if (arg == "--threads")
+            baker.threads = std::atoi(value);
+        else
+        {
+            printUsage();
+            return false;
+        }
+    }
+    if (baker.spacing <= 0.0f || baker.maxProbes < 8 || baker.rays < 16 || baker.albedo < 0.0f || baker.bias < 0.0f
+        || baker.threads < 0)
+    {
+        printUsage();
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    BakerOptions options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    // shaders and resources are looked up relative to the working directory, like main.cpp
+    if (chdir(options.dataDir.c_str()) != 0)
+    {
+        std::cerr << "Cannot change directory to " << options.dataDir << std::endl;
+        return 1;
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc)mockgl::getProcAddress))
+    {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return 1;
+    }
+    // the mock's programs are not worth caching
+    ProgramCache::enabled() = false;
+
+    // the geometry stays in RAM for the baker
+    Scene *scene = new Scene(true);
+    const Model &model = scene->staticModel();
+    if (model.meshes.empty())
+    {
+        std::cerr << "de_dust2 has no meshes, nothing to bake" << std::endl;
+        delete scene;
+        return 1;
+    }
+
+    ProbeBaker &baker = options.baker;
+    IrradianceProbeData data = baker.bake(model, scene->staticModelMatrix(), scene->staticSunDirection());
+    delete scene;
+    if (data.probeCount() == 0)
+    {
+        std::cerr << "de_dust2 has no triangles, nothing to bake" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Baked " << data.probeCount() << " irradiance probes (" << baker.validProbes << " valid): "
+              << data.size.x << " x " << data.size.y << " x " << data.size.z << " every " << baker.bakedSpacing
+              << " units, " << baker.rays << " rays each, " << baker.triangles << " triangles, " << baker.bvhNodes
+              << " BVH nodes; " << baker.traceMs << " ms" << std::endl;
+    if (!data.write(options.outputPath))
+        return 1;
+    std::cout << "Wrote " << options.outputPath << std::endl;
+    return 0;
+}
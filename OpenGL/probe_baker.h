@@ -0,0 +1,262 @@
+#ifndef PROBE_BAKER_H
+#define PROBE_BAKER_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <stb_image.h>
+
+#include <learnopengl/model.h>
+
+#include "irradiance_probes.h"
+#include "triangle_bvh.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Bakes irradiance probes over a model on the CPU (see probe_baker.cpp):
+// 1. a grid with spacing between probes is laid over the model's bounds; if it would hold more
+//    than maxProbes, the spacing grows until it does not;
+// 2. every probe, on all cores, sends rays in evenly spread directions (a spherical Fibonacci
+//    set) to the closest surface. A ray leaving the model sees the sky, the sun's ambient colour;
+//    a ray hitting a front face sees that surface as the renderer lights it without the lamps:
+//    its albedo under the ambient colour, and under the sun's diffuse colour if the sun reaches
+//    it, with a shadow ray. The albedo of a mesh is the average of its diffuse texture;
+// 3. the radiance is projected onto the 9 L2 spherical harmonics and convolved with the cosine
+//    lobe, giving the irradiance for any normal (IrradianceProbeData). More than a quarter of the
+//    rays hitting back faces means the probe is inside a wall: it is marked not valid.
+class ProbeBaker
+{
+public:
+    // more back faces than this fraction of the rays: the probe is inside geometry
+    static constexpr float MAX_BACK_FACES = 0.25f;
+
+    // settings
+    float spacing;      // world units between probes
+    size_t maxProbes;   // the spacing grows beyond this
+    int rays;           // directions per probe
+    float albedo;       // of meshes without a diffuse texture
+    float bias;         // shadow rays start this far off the surface
+    int threads;        // 0: every core
+
+    // results of the last bake()
+    size_t triangles;
+    size_t bvhNodes;
+    size_t validProbes;
+    float bakedSpacing;
+    double traceMs;
+
+    ProbeBaker()
+        : spacing(2.0f), maxProbes(65536), rays(256), albedo(0.5f), bias(0.01f), threads(0),
+          triangles(0), bvhNodes(0), validProbes(0), bakedSpacing(0.0f), traceMs(0.0)
+    {
+    }
+
+    // the meshes of model need their vertices and indices (keepGeometry); sunDirection is the
+    // direction the sunlight travels, as dir_light::direction
+    IrradianceProbeData bake(const Model &model, const glm::mat4 &modelMatrix, const glm::vec3 &sunDirection)
+    {
+        auto start = std::chrono::steady_clock::now();
+        IrradianceProbeData data;
+
+        // world-space triangles and what the closest hit needs to shade them
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(modelMatrix)));
+        std::vector<TriangleBvh::Triangle> soup;
+        std::vector<Surface> surfaces;
+        glm::vec3 boundsMin(INFINITY), boundsMax(-INFINITY);
+        std::map<std::string, glm::vec3> textureAlbedos;
+        for (const Mesh &mesh : model.meshes)
+        {
+            glm::vec3 meshAlbedo = diffuseAlbedo(model, mesh, textureAlbedos);
+            std::vector<glm::vec3> positions, normals;
+            for (const Vertex &vertex : mesh.vertices)
+            {
+                positions.push_back(glm::vec3(modelMatrix * glm::vec4(vertex.Position, 1.0f)));
+                boundsMin = glm::min(boundsMin, positions.back());
+                boundsMax = glm::max(boundsMax, positions.back());
+                normals.push_back(normalMatrix * vertex.Normal);
+            }
+            for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+            {
+                const unsigned int *corner = &mesh.indices[i];
+                soup.push_back({ positions[corner[0]], positions[corner[1]], positions[corner[2]] });
+                surfaces.push_back({ { normals[corner[0]], normals[corner[1]], normals[corner[2]] }, meshAlbedo });
+            }
+        }
+        triangles = soup.size();
+        if (soup.empty())
+            return data;
+
+        bakedSpacing = spacing;
+        glm::vec3 extent = boundsMax - boundsMin;
+        for (;;)
+        {
+            data.size = glm::max(glm::ivec3(glm::ceil(extent / bakedSpacing)) + 1, glm::ivec3(2));
+            if (data.probeCount() <= maxProbes)
+                break;
+            bakedSpacing *= 1.25f;
+        }
+        data.spacing = bakedSpacing;
+        // centred on the model
+        data.origin = (boundsMin + boundsMax) * 0.5f - glm::vec3(data.size - 1) * (bakedSpacing * 0.5f);
+
+        TriangleBvh bvh(std::move(soup));
+        bvhNodes = bvh.nodeCount();
+        trace(bvh, surfaces, glm::normalize(-sunDirection), glm::length(extent) + bakedSpacing * 2.0f, data);
+        traceMs = millisecondsSince(start);
+        return data;
+    }
+
+private:
+    struct Surface
+    {
+        glm::vec3 normals[3];
+        glm::vec3 albedo;
+    };
+
+    static double millisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // the 9 real L2 spherical harmonics of a unit direction, in the order of probes.glsl
+    static void shBasis(const glm::vec3 &d, float basis[9])
+    {
+        basis[0] = 0.282095f;
+        basis[1] = 0.488603f * d.y;
+        basis[2] = 0.488603f * d.z;
+        basis[3] = 0.488603f * d.x;
+        basis[4] = 1.092548f * d.x * d.y;
+        basis[5] = 1.092548f * d.y * d.z;
+        basis[6] = 0.315392f * (3.0f * d.z * d.z - 1.0f);
+        basis[7] = 1.092548f * d.x * d.z;
+        basis[8] = 0.546274f * (d.x * d.x - d.y * d.y);
+    }
+
+    // average colour of the mesh's first diffuse texture, read again from its file
+    glm::vec3 diffuseAlbedo(const Model &model, const Mesh &mesh, std::map<std::string, glm::vec3> &cache) const
+    {
+        for (const Texture &texture : mesh.textures)
+        {
+            if (texture.type != "texture_diffuse")
+                continue;
+            auto cached = cache.find(texture.path);
+            if (cached != cache.end())
+                return cached->second;
+            glm::vec3 average(albedo);
+            int width, height, components;
+            std::string filename = model.directory + '/' + texture.path;
+            unsigned char *pixels = stbi_load(filename.c_str(), &width, &height, &components, 3);
+            if (pixels && width > 0 && height > 0)
+            {
+                glm::dvec3 sum(0.0);
+                size_t count = (size_t)width * height;
+                for (size_t i = 0; i < count; i++)
+                    sum += glm::dvec3(pixels[i * 3], pixels[i * 3 + 1], pixels[i * 3 + 2]);
+                average = glm::vec3(sum / (255.0 * count));
+            }
+            stbi_image_free(pixels);
+            cache[texture.path] = average;
+            return average;
+        }
+        return glm::vec3(albedo);
+    }
+
+    void trace(const TriangleBvh &bvh, const std::vector<Surface> &surfaces, const glm::vec3 &toSun, float reach,
+               IrradianceProbeData &data)
+    {
+        // spherical Fibonacci directions, the same for every probe, and their harmonics
+        std::vector<glm::vec3> directions(rays);
+        std::vector<float> bases((size_t)rays * 9);
+        for (int i = 0; i < rays; i++)
+        {
+            float z = 1.0f - (2.0f * i + 1.0f) / rays;
+            float radius = std::sqrt(std::max(0.0f, 1.0f - z * z));
+            float angle = 2.3999632f * i; // the golden angle
+            directions[i] = glm::vec3(radius * std::cos(angle), radius * std::sin(angle), z);
+            shBasis(directions[i], &bases[(size_t)i * 9]);
+        }
+        // the cosine lobe over pi keeps band l by 1, 2/3 and 1/4
+        const float bands[9] = { 1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+
+        data.coefficients.assign(data.probeCount() * IrradianceProbeData::COEFFICIENTS, 0);
+        data.valid.assign(data.probeCount(), 0);
+        std::atomic<size_t> nextProbe(0);
+        std::atomic<size_t> valid(0);
+        auto work = [&]() {
+            for (size_t probe = nextProbe++; probe < data.probeCount(); probe = nextProbe++)
+            {
+                glm::ivec3 cell((int)(probe % data.size.x), (int)(probe / data.size.x % data.size.y),
+                                (int)(probe / ((size_t)data.size.x * data.size.y)));
+                glm::vec3 position = data.origin + glm::vec3(cell) * data.spacing;
+
+                glm::vec3 sky[9] = {}, sun[9] = {};
+                int backFaces = 0;
+                for (int i = 0; i < rays; i++)
+                {
+                    const glm::vec3 &direction = directions[i];
+                    glm::vec3 skyRadiance(1.0f), sunRadiance(0.0f);
+                    TriangleBvh::Hit hit;
+                    if (bvh.intersect(position, direction, reach, hit))
+                    {
+                        const Surface &surface = surfaces[hit.triangle];
+                        glm::vec3 normal = surface.normals[0] * (1.0f - hit.u - hit.v) + surface.normals[1] * hit.u +
+                                           surface.normals[2] * hit.v;
+                        float length = glm::length(normal);
+                        normal = length > 0.0f ? normal / length : -direction;
+                        if (glm::dot(normal, direction) > 0.0f)
+                        {
+                            backFaces++;
+                            continue;
+                        }
+                        skyRadiance = surface.albedo;
+                        glm::vec3 point = position + direction * hit.distance + normal * bias;
+                        float diff = glm::dot(normal, toSun);
+                        if (diff > 0.0f && !bvh.occluded(point, toSun, reach))
+                            sunRadiance = surface.albedo * diff;
+                    }
+                    const float *basis = &bases[(size_t)i * 9];
+                    for (int k = 0; k < 9; k++)
+                    {
+                        sky[k] += skyRadiance * basis[k];
+                        sun[k] += sunRadiance * basis[k];
+                    }
+                }
+
+                // every ray stands for the same solid angle. Rays hitting back faces see nothing
+                // known, so the others share the whole sphere instead of counting them as black
+                int usedRays = std::max(rays - backFaces, 1);
+                const float weight = 4.0f * 3.14159265f / usedRays;
+                uint16_t *out = &data.coefficients[probe * IrradianceProbeData::COEFFICIENTS];
+                for (int k = 0; k < 9; k++)
+                    for (int c = 0; c < 3; c++)
+                    {
+                        out[k * 3 + c] = glm::packHalf1x16(sky[k][c] * weight * bands[k]);
+                        out[27 + k * 3 + c] = glm::packHalf1x16(sun[k][c] * weight * bands[k]);
+                    }
+                if (backFaces <= MAX_BACK_FACES * rays)
+                {
+                    data.valid[probe] = 1;
+                    valid++;
+                }
+            }
+        };
+
+        int threadCount = threads > 0 ? threads : std::max(1, (int)std::thread::hardware_concurrency());
+        std::vector<std::thread> workers;
+        for (int i = 1; i < threadCount; i++)
+            workers.emplace_back(work);
+        work();
+        for (std::thread &worker : workers)
+            worker.join();
+        validProbes = valid;
+    }
+};
+
+#endif
@@ -0,0 +1,60 @@
+// Baked irradiance probes of the dynamic objects (probe_baker.cpp, irradiance_probes.h): a grid
+// over de_dust2, each probe the L2 spherical harmonics of the light arriving at it from the
+// scene. Included by lighting.glsl.
+#include "scene_blocks.glsl"
+
+// 7 vec4 per probe, x fastest, then y, then z: the 9 RGB coefficients of its irradiance, already
+// convolved with the cosine lobe, divided by pi and tinted by the current sun/moon, then 1.0 for
+// a probe in the open or 0.0 for one buried in a wall
+layout (std430, binding = 7) readonly buffer IrradianceProbes
+{
+    vec4 probeData[];
+};
+
+// irradiance of a probe for a surface facing normal, over pi: a diffuse colour times it is the
+// ambient term
+vec3 EvalProbe(int probe, vec3 normal)
+{
+    int first = probe * 7;
+    vec4 a = probeData[first];
+    vec4 b = probeData[first + 1];
+    vec4 c = probeData[first + 2];
+    vec4 d = probeData[first + 3];
+    vec4 e = probeData[first + 4];
+    vec4 f = probeData[first + 5];
+    vec4 g = probeData[first + 6];
+    vec3 n = normal;
+    return 0.282095 * a.xyz
+         + 0.488603 * (n.y * vec3(a.w, b.xy) + n.z * vec3(b.zw, c.x) + n.x * c.yzw)
+         + 1.092548 * (n.x * n.y * d.xyz + n.y * n.z * vec3(d.w, e.xy) + n.x * n.z * f.yzw)
+         + 0.315392 * (3.0 * n.z * n.z - 1.0) * vec3(e.zw, f.x)
+         + 0.546274 * (n.x * n.x - n.y * n.y) * g.xyz;
+}
+
+// the sun's ambient light reaching a surface at worldPos facing normal: the trilinear blend of
+// the 8 probes around it, skipping buried ones, or the flat dirLight.ambient without probes
+vec3 SampleProbeAmbient(vec3 worldPos, vec3 normal)
+{
+    if (probeGridSize.w == 0)
+        return dirLight.ambient;
+    // outside the grid the closest probes on its border are used
+    vec3 cell = clamp((worldPos - probeGridOrigin.xyz) / probeGridOrigin.w, vec3(0.0), vec3(probeGridSize.xyz - 1));
+    ivec3 base = min(ivec3(cell), probeGridSize.xyz - 2);
+    vec3 t = cell - vec3(base);
+    vec3 sum = vec3(0.0);
+    float weights = 0.0;
+    for (int i = 0; i < 8; i++)
+    {
+        ivec3 corner = ivec3(i & 1, (i >> 1) & 1, i >> 2);
+        vec3 w = mix(1.0 - t, t, vec3(corner));
+        ivec3 p = base + corner;
+        int probe = p.x + probeGridSize.x * (p.y + probeGridSize.y * p.z);
+        float weight = w.x * w.y * w.z * probeData[probe * 7 + 6].w;
+        if (weight > 0.0)
+        {
+            sum += weight * EvalProbe(probe, normal);
+            weights += weight;
+        }
+    }
+    return weights > 0.0 ? max(sum / weights, vec3(0.0)) : dirLight.ambient;
+}
@@ -0,0 +1,1058 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <learnopengl/shader_t.h>
+#include <learnopengl/shader_variants.h>
+#include <learnopengl/mesh.h>
+#include <learnopengl/model.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/profiler.h>
+#include <learnopengl/gpu_timer.h>
+
+#include <learnopengl/uniform_buffer.h>
+
+#include "light.h"
+#include "light_registry.h"
+#include "light_clusters.h"
+#include "object_lights.h"
+#include "deferred_renderer.h"
+#include "shadow_cascades.h"
+#include "spot_shadows.h"
+#include "lightmap.h"
+#include "irradiance_probes.h"
+#include "uniform_blocks.h"
+#include "shader_features.h"
+#include "car.h"
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+const glm::vec3 day_sky_color = glm::vec3(135.0f, 206.0f, 235.0f) / 255.0f; // html skyblue
+const glm::vec3 night_sky_color = glm::vec3(0.1f, 0.1f, 0.1f);
+
+// Mesh::Draw binds the textures below the units of the shadow maps and the lightmap
+static_assert(Mesh::MAX_TEXTURES < SHADOW_MAP_UNIT, "mesh textures overlap the scene's units");
+
+enum time_of_day
+{
+    DAY,
+    NIGHT
+};
+
+enum render_path
+{
+    FORWARD_SHADING,
+    DEFERRED_SHADING
+};
+
+// de_dust2's static lights baked by lightmap_baker, read by Scene when it exists
+const char *const DUST2_LIGHTMAP_PATH = "resources/de_dust2/de_dust2.lightmap";
+// written by probe_baker.cpp
+const char *const DUST2_PROBES_PATH = "resources/de_dust2/de_dust2.probes";
+
+// the shared point lights are tuned for the scene (diffuse 0.8); the car body is lit by 0.5 of
+// them. Passed to car_shader.fs and, on the deferred path, stored in the G-buffer
+const float CAR_POINT_DIFFUSE_SCALE = 0.625f;
+
+// passes timed on the GPU, in draw order; GPU_PASS_IMGUI is timed by main.cpp
+enum gpu_pass
+{
+    GPU_PASS_SHADOWS,
+    GPU_PASS_SPOT_SHADOWS,
+    GPU_PASS_LIGHT_CULLING,
+    GPU_PASS_CUBES,
+    GPU_PASS_LIGHT_CUBES,
+    GPU_PASS_DE_DUST2,
+    GPU_PASS_CAR,
+    GPU_PASS_FLAG,
+    GPU_PASS_DEFERRED_LIGHTING,
+    GPU_PASS_IMGUI,
+    GPU_PASS_COUNT
+};
+
+// what drawShadowCasters draws: de_dust2 never moves, everything else may
+enum shadow_casters
+{
+    STATIC_CASTERS = 1,
+    DYNAMIC_CASTERS = 2,
+    ALL_CASTERS = STATIC_CASTERS | DYNAMIC_CASTERS
+};
+
+struct bezierSurfaceVertex
+{
+    glm::vec3 position;
+    glm::vec2 texCoords;
+};
+
+inline unsigned int loadTexture(const char *path);
+
+// The whole 3D scene: shaders, models, lights and the state driven by input.
+// Shared by the interactive executable (main.cpp) and the headless benchmark (bench.cpp),
+// so both run exactly the same setup and per-frame work. Needs a current GL context.
+class Scene
+{
+public:
+    static const int rez = 4;
+    static const unsigned int NUM_PATCH_PTS = 16;
+    static constexpr float NEAR_PLANE = 0.01f;
+    static constexpr float FAR_PLANE = 100.0f;
+
+    // state driven by input
+    Car car;
+
+    Camera mainCamera;
+    Camera carCamera;
+    Camera staticCamera;
+    Camera *activeCamera;
+
+    time_of_day current_time_of_day;
+    glm::vec3 fogColor;
+    float fogIntensity;
+    bool blinn;
+    // clustered forward shading (LightClusters) instead of every fragment looping over every light
+    bool clustered;
+    // with clustered: colour by the number of lights in each froxel
+    bool clusterHeatmap;
+    // forward shading without clustered: each object only loops over the lights that reach it
+    // (ObjectLights)
+    bool perObjectLights;
+    render_path renderPath;
+    // forward shading: de_dust2 takes its static lights from dust2Lightmap, when one was baked
+    bool useLightmap;
+    // forward shading: the containers, the car and the flag take their ambient from dust2Probes,
+    // when they were baked
+    bool useProbes;
+    // the flag with the container's diffuse and specular maps instead of its grey material
+    bool flagTextured;
+
+    // build and compile our shader zprogram
+    // ------------------------------------
+    // the lit shaders are compiled per combination of shader_feature bits (litFeatures())
+    ShaderVariants lightingShader;
+    Shader lightCubeShader;
+    ShaderVariants ourShader;
+    ShaderVariants carShader;
+    ShaderVariants bezierSurfaceShader;
+    // G-buffer variants for the deferred path
+    Shader gBufferShader;
+    ShaderVariants gBufferFlagShader;
+    // depth-only programs of the shadow maps: positions, and the flag's tessellated surface
+    Shader shadowDepthShader;
+    Shader flagDepthShader;
+
+    // every point light and spotlight, including the car's headlights
+    LightRegistry lights;
+    // constructed before the models so their shaders also compile while the models load
+    LightClusters lightClusters;
+    ObjectLights objectLights;
+    DeferredRenderer deferred;
+    // the sun's / moon's shadows, settings included
+    ShadowCascades shadows;
+    // the headlights' shadows, settings included
+    SpotShadows spotShadows;
+    // de_dust2's baked static lights and ambient occlusion (lightmap_baker.cpp)
+    Lightmap dust2Lightmap;
+    // irradiance probes over de_dust2 for the dynamic objects (probe_baker.cpp)
+    IrradianceProbes dust2Probes;
+
+    // load models
+    // -----------
+    Model bmw_g82_m4_model;
+    Model de_dust2_model;
+
+    // GPU time of every gpu_pass
+    GpuTimer gpuTimer;
+
+    // keepModelGeometry keeps the models' vertices and indices in RAM after upload (nothing in the scene reads them)
+    explicit Scene(bool keepModelGeometry = false)
+        : car(glm::vec3(16.0f, 0.0f, -21.0f)),
+          mainCamera(glm::vec3(0.0f, 0.0f, -21.0f)),
+          carCamera(car.position),
+          staticCamera(glm::vec3(17.5f, 3.5f, -22.5f), glm::vec3(0.0f, 1.0f, 0.0f), 150.0f, -45.0f),
+          activeCamera(&carCamera),
+          current_time_of_day(DAY),
+          fogColor(0.5f, 0.5f, 0.5f),
+          fogIntensity(1.0f),
+          blinn(false),
+          clustered(false),
+          clusterHeatmap(false),
+          perObjectLights(false),
+          renderPath(FORWARD_SHADING),
+          useLightmap(true),
+          useProbes(true),
+          flagTextured(false),
+          lightingShader(SHADER_FEATURES, litFeatures(), "6.multiple_lights.vs", "6.multiple_lights.fs"),
+          lightCubeShader("6.light_cube.vs", "6.light_cube.fs"),
+          ourShader(SHADER_FEATURES, dust2Precompile(), "1.model_loading.vs", "1.model_loading.fs"),
+          carShader(SHADER_FEATURES, litFeatures(), "car_shader.vs", "car_shader.fs"),
+          bezierSurfaceShader(SHADER_FEATURES, flagFeatures(litFeatures()), "bezier_surface.vs", "bezier_surface.fs", nullptr,
+                              "bezier_surface.tcs", "bezier_surface.tes"),
+          gBufferShader("1.model_loading.vs", "gbuffer.fs"),
+          gBufferFlagShader(SHADER_FEATURES, flagFeatures(0), "bezier_surface.vs", "gbuffer_flag.fs", nullptr,
+                            "bezier_surface.tcs", "bezier_surface.tes"),
+          shadowDepthShader("shadow_depth.vs", "shadow_depth.fs"),
+          flagDepthShader("bezier_surface.vs", "shadow_depth.fs", nullptr, "bezier_surface.tcs", "bezier_surface.tes",
+                          { "DEPTH_ONLY" }),
+          bmw_g82_m4_model("resources/FINAL_MODEL_M22/FINAL_MODEL_M22.fbx", false, keepModelGeometry),
+          de_dust2_model("resources/de_dust2/de_dust2.obj", false, keepModelGeometry),
+          gpuTimer({ "shadows", "spot_shadows", "light_culling", "cubes", "light_cubes", "de_dust2", "car", "flag", "deferred_lighting", "imgui" }),
+          cameraBuffer(CAMERA_BLOCK_BINDING),
+          lightingBuffer(LIGHTING_BLOCK_BINDING)
+    {
+        // configure global opengl state
+        // -----------------------------
+        glEnable(GL_DEPTH_TEST);
+
+        // texture units of the containers, also used by the textured flag
+        auto containerMaps = [](Shader &shader) {
+            shader.setInt("texture_diffuse1", 0);
+            shader.setInt("texture_specular1", 1);
+        };
+        lightingShader.onCreate(containerMaps);
+        bezierSurfaceShader.onCreate(containerMaps);
+        gBufferFlagShader.onCreate(containerMaps);
+
+        daylight.direction = glm::vec3(-1.0f, -1.0f, -1.0f);
+        daylight.ambient = glm::vec3(0.5f, 0.4f, 0.3f);
+        daylight.diffuse = glm::vec3(0.5f, 0.4f, 0.3f);
+        daylight.specular = glm::vec3(1.0f, 0.8f, 0.6f);
+
+        night_light.direction = glm::vec3(-1.0f, -1.0f, -1.0f);
+        night_light.ambient = glm::vec3(0.03f, 0.04f, 0.05f);
+        night_light.diffuse = glm::vec3(0.03f, 0.04f, 0.05f);
+        night_light.specular = glm::vec3(0.06f, 0.08f, 0.1f);
+
+        for (const glm::vec3 &position : pointLightPositions)
+        {
+            point_light lamp;
+            lamp.position = position;
+            lamp.ambient = glm::vec3(0.05f, 0.05f, 0.05f);
+            lamp.diffuse = glm::vec3(0.8f, 0.8f, 0.8f);
+            lamp.specular = glm::vec3(1.0f, 1.0f, 1.0f);
+            lamp.constant = 1.0f;
+            lamp.linear = 0.09f;
+            lamp.quadratic = 0.032f;
+            lights.addPointLight(lamp);
+        }
+
+        // the headlights follow the car; render() updates their position and direction
+        for (int i = 0; i < 2; i++)
+        {
+            spotlight headlight;
+            headlight.ambient = glm::vec3(0.0f, 0.0f, 0.0f);
+            headlight.diffuse = glm::vec3(1.0f, 1.0f, 1.0f);
+            headlight.specular = glm::vec3(1.0f, 1.0f, 1.0f);
+            headlight.constant = 1.0f;
+            headlight.linear = 0.09f;
+            headlight.quadratic = 0.032f;
+            headlight.cutOff = glm::cos(glm::radians(12.5f));
+            headlight.outerCutOff = glm::cos(glm::radians(15.0f));
+            headlight.shadowLayer = i;
+            headlights[i] = lights.addSpotlight(headlight);
+        }
+
+        dust2_model_matrix = glm::mat4(1.0f);
+        dust2_model_matrix = glm::scale(dust2_model_matrix, glm::vec3(0.01f));
+        dust2_model_matrix = glm::rotate(dust2_model_matrix, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+
+        // the lightmap must match the lamps and de_dust2's placement, so it is read once both are set
+        dust2Lightmap.load(DUST2_LIGHTMAP_PATH, de_dust2_model, dust2_model_matrix, staticPointLights());
+        dust2Probes.load(DUST2_PROBES_PATH);
+
+        // the shaders above were only submitted; the driver compiled them while the models loaded
+        unsigned int features = litFeatures();
+        for (Shader *shader : { &lightingShader.get(features), &lightCubeShader, &ourShader.get(dust2Features(features)), &carShader.get(features),
+                                &bezierSurfaceShader.get(flagFeatures(features)), &gBufferShader, &gBufferFlagShader.get(flagFeatures(0)),
+                                &shadowDepthShader, &flagDepthShader })
+            shader->finish();
+
+        // uniforms set once per draw inside loops
+        lightCubeModelUniform = lightCubeShader.uniform("model");
+        gBufferModelUniform = gBufferShader.uniform("model");
+        shadowDepthModelUniform = shadowDepthShader.uniform("model");
+        shadowDepthLightSpaceUniform = shadowDepthShader.uniform("lightSpace");
+
+        // set up vertex data (and buffer(s)) and configure vertex attributes
+        // ------------------------------------------------------------------
+        const float cube_vertices[] = {
+            // positions          // normals           // texture coords
+            -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+             0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
+             0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+             0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+            -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+
+            -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+             0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
+             0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+             0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+            -0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+
+            -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+            -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+            -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+            -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+            -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+            -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+             0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+             0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+             0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+             0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+             0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+             0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+            -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+             0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
+             0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+             0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+
+            -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
+             0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
+             0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+             0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+            -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
+            -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
+        };
+
+        // first, configure the cube's VAO (and VBO)
+        glGenVertexArrays(1, &cubeVAO);
+        glGenBuffers(1, &VBO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(cube_vertices), cube_vertices, GL_STATIC_DRAW);
+
+        glBindVertexArray(cubeVAO);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(6 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+
+        // second, configure the light's VAO (VBO stays the same; the vertices are the same for the light object which is also a 3D cube)
+        glGenVertexArrays(1, &lightCubeVAO);
+        glBindVertexArray(lightCubeVAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        // note that we update the lamp's position attribute's stride to reflect the updated buffer data
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
+        glEnableVertexAttribArray(0);
+
+        // load textures (we now use a utility function to keep the code more organized)
+        // -----------------------------------------------------------------------------
+        diffuseMap = loadTexture("container2.png");
+        specularMap = loadTexture("container2_specular.png");
+
+        flagMatrix = glm::mat4(1.0f);
+        flagMatrix = glm::translate(flagMatrix, glm::vec3(10.5f, 2.0f, -23.5f));
+        flagMatrix = glm::scale(flagMatrix, glm::vec3(0.4f));
+        flagMatrix = glm::rotate(flagMatrix, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+        glGenVertexArrays(1, &bezierSurfaceVAO);
+        glBindVertexArray(bezierSurfaceVAO);
+
+        glGenBuffers(1, &bezierSurfaceVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, bezierSurfaceVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(bezierSurfaceVertices), &bezierSurfaceVertices[0], GL_DYNAMIC_DRAW);
+
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        glPatchParameteri(GL_PATCH_VERTICES, NUM_PATCH_PTS);
+    }
+
+    ~Scene()
+    {
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        glDeleteVertexArrays(1, &cubeVAO);
+        glDeleteVertexArrays(1, &lightCubeVAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteVertexArrays(1, &bezierSurfaceVAO);
+        glDeleteBuffers(1, &bezierSurfaceVBO);
+    }
+
+    Scene(const Scene &) = delete;
+    Scene &operator=(const Scene &) = delete;
+
+    // stress test: scatters pointCount coloured lamps and spotCount downward spotlights over the
+    // map, on top of the regular lights. The layout is deterministic so runs are comparable.
+    void addStressLights(int pointCount, int spotCount)
+    {
+        const glm::vec3 areaMin(-5.0f, 0.5f, -40.0f);
+        const glm::vec3 areaSize(35.0f, 2.5f, 40.0f);
+
+        for (int i = 0; i < pointCount; i++)
+        {
+            // low-discrepancy sequence: spread evenly without lining up on a grid
+            float u = std::fmod(0.5f + i * 0.6180340f, 1.0f);
+            float v = std::fmod(0.5f + i * 0.7548777f, 1.0f);
+            float w = std::fmod(0.5f + i * 0.5698403f, 1.0f);
+            float hue = std::fmod(i * 0.1372f, 1.0f) * 6.2831853f;
+            glm::vec3 color = 0.5f + 0.5f * glm::vec3(std::cos(hue), std::cos(hue - 2.0944f), std::cos(hue + 2.0944f));
+
+            point_light lamp;
+            lamp.position = areaMin + areaSize * glm::vec3(u, w, v);
+            lamp.ambient = glm::vec3(0.0f);
+            lamp.diffuse = color;
+            lamp.specular = color;
+            // falls to a few percent within ~7 units
+            lamp.constant = 1.0f;
+            lamp.linear = 0.7f;
+            lamp.quadratic = 1.8f;
+            lights.addPointLight(lamp);
+        }
+
+        for (int i = 0; i < spotCount; i++)
+        {
+            float u = std::fmod(0.25f + i * 0.6180340f, 1.0f);
+            float v = std::fmod(0.25f + i * 0.7548777f, 1.0f);
+
+            spotlight spot;
+            spot.position = areaMin + areaSize * glm::vec3(u, 1.0f, v) + glm::vec3(0.0f, 2.0f, 0.0f);
+            spot.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+            spot.ambient = glm::vec3(0.0f);
+            spot.diffuse = glm::vec3(1.0f, 0.9f, 0.7f);
+            spot.specular = glm::vec3(1.0f, 0.9f, 0.7f);
+            spot.constant = 1.0f;
+            spot.linear = 0.35f;
+            spot.quadratic = 0.44f;
+            spot.cutOff = glm::cos(glm::radians(20.0f));
+            spot.outerCutOff = glm::cos(glm::radians(25.0f));
+            lights.addSpotlight(spot);
+        }
+    }
+
+    // renders one frame into the currently bound framebuffer.
+    // time drives the flag animation, aspect is the viewport width / height.
+    void render(double time, float aspect)
+    {
+        gpuTimer.beginFrame();
+
+        // render
+        // ------
+        {
+            PROFILE_ZONE("Clear");
+            switch (current_time_of_day)
+            {
+            case DAY:
+                glClearColor(day_sky_color.x, day_sky_color.y, day_sky_color.z, 1.0f);
+                active_light = daylight;
+                fogColor = glm::vec3(0.5f);
+                break;
+            case NIGHT:
+                glClearColor(night_sky_color.x, night_sky_color.y, night_sky_color.z, 1.0f);
+                active_light = night_light;
+                fogColor = glm::vec3(0.1f);
+                break;
+            }
+
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
+
+        {
+            PROFILE_ZONE("Bezier control points");
+            for (int i = 0; i < rez; i++)
+            {
+                for (int j = 0; j < rez; j++)
+                {
+                    bezierSurfaceVertices[i][j].position.x = float(i);
+                    bezierSurfaceVertices[i][j].texCoords = glm::vec2(i / float(rez - 1), j / float(rez - 1));
+                }
+            }
+            for (int j = 0; j < rez; j++)
+            {
+                bezierSurfaceVertices[0][j].position.y = j * 0.5f;
+                bezierSurfaceVertices[1][j].position.y = j * 0.5f + float(cos(time));
+                bezierSurfaceVertices[2][j].position.y = j * 0.5f + float(sin(time));
+                bezierSurfaceVertices[3][j].position.y = j * 0.5f;
+            }
+            for (int i = 0; i < rez; i++)
+            {
+                bezierSurfaceVertices[i][0].position.z = 0.0f;
+                bezierSurfaceVertices[i][1].position.z = float(cos(time));
+                bezierSurfaceVertices[i][2].position.z = float(sin(time));
+                bezierSurfaceVertices[i][3].position.z = 0.0f;
+            }
+
+            glBindVertexArray(bezierSurfaceVAO);
+            glBindBuffer(GL_ARRAY_BUFFER, bezierSurfaceVBO);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(bezierSurfaceVertices), &bezierSurfaceVertices[0], GL_DYNAMIC_DRAW);
+            glBindVertexArray(0);
+        }
+
+        glm::mat4 bmw_model_matrix(1.0f);
+        {
+            PROFILE_ZONE("Car and spotlights");
+            bmw_model_matrix = glm::translate(bmw_model_matrix, car.position);
+            bmw_model_matrix = glm::rotate(bmw_model_matrix, car.yaw, glm::vec3(0.0f, 1.0f, 0.0f));
+            bmw_model_matrix = glm::scale(bmw_model_matrix, glm::vec3(0.5f));
+
+            glm::vec4 baseCarCameraPosition = glm::vec4(0.0f, 2.0f, -4.0f, 1.0f);
+            carCamera.Position = glm::vec3(bmw_model_matrix * baseCarCameraPosition);
+            carCamera.SetYaw(-glm::degrees(car.yaw - glm::radians(90.0f)));
+
+            glm::vec4 baseCarSpotlight1 = glm::vec4(0.8f, 0.8f, 1.0f, 1.0f);
+            glm::vec4 baseCarSpotlight2 = glm::vec4(-0.8f, 0.8f, 1.0f, 1.0f);
+
+            lights.spotLight(headlights[0]).position = bmw_model_matrix * baseCarSpotlight1;
+            lights.spotLight(headlights[1]).position = bmw_model_matrix * baseCarSpotlight2;
+            glm::mat4 spotlightDirectionMatrix(1.0f);
+
+            spotlightDirectionMatrix = glm::rotate(spotlightDirectionMatrix, car.yaw, glm::vec3(0.0f, 1.0f, 0.0f));
+            spotlightDirectionMatrix = glm::rotate(spotlightDirectionMatrix, car.spotlightPitch, glm::vec3(1.0f, 0.0f, 0.0f));
+
+            for (int i = 0; i < 2; i++)
+                lights.spotLight(headlights[i]).direction = glm::vec3(spotlightDirectionMatrix * glm::vec4(0.0f, 0.0f, 1.0f, 0.0f));
+        }
+
+        // view/projection transformations
+        glm::mat4 projection = glm::perspective(glm::radians(activeCamera->Zoom), aspect, NEAR_PLANE, FAR_PLANE);
+        glm::mat4 view = activeCamera->GetViewMatrix();
+
+        {
+            PROFILE_ZONE("Uniform blocks");
+            // camera and lighting state is the same for every shader: upload it once
+            camera_block camera;
+            camera.view = view;
+            camera.projection = projection;
+            camera.viewPos = activeCamera->Position;
+            cameraBuffer.upload(camera);
+
+            lighting_block lighting = {};
+            lighting.dirLight = active_light.std140();
+            lighting.fogColor = fogColor;
+            lighting.fogIntensity = fogIntensity;
+            lighting.pointLightCount = lights.pointLightCount();
+            lighting.spotLightCount = lights.spotlightCount();
+            GLint viewport[4];
+            glGetIntegerv(GL_VIEWPORT, viewport);
+            lightClusters.describe(lighting, glm::vec2(viewport[2], viewport[3]), FAR_PLANE);
+            dust2Probes.update(active_light);
+            dust2Probes.describe(lighting, useProbes);
+            lightingBuffer.upload(lighting);
+
+            lights.upload();
+        }
+
+        {
+            PROFILE_ZONE("Shadows");
+            GpuTimer::Scope gpuScope(gpuTimer, GPU_PASS_SHADOWS);
+            shadows.measuredMs = gpuTimer.passes[GPU_PASS_SHADOWS].averageMs();
+            shadows.render(view, glm::radians(activeCamera->Zoom), aspect, NEAR_PLANE, active_light.direction,
+                           [&](const glm::mat4 &lightSpace) { drawShadowCasters(lightSpace, bmw_model_matrix, ALL_CASTERS); });
+        }
+
+        {
+            PROFILE_ZONE("Spot shadows");
+            GpuTimer::Scope gpuScope(gpuTimer, GPU_PASS_SPOT_SHADOWS);
+            spotShadows.render(lights,
+                               [&](const glm::mat4 &lightSpace) { drawShadowCasters(lightSpace, bmw_model_matrix, STATIC_CASTERS); },
+                               [&](const glm::mat4 &lightSpace) { drawShadowCasters(lightSpace, bmw_model_matrix, DYNAMIC_CASTERS); });
+        }
+
+        if (clustered && renderPath == FORWARD_SHADING)
+        {
+            PROFILE_ZONE("Light culling");
+            GpuTimer::Scope gpuScope(gpuTimer, GPU_PASS_LIGHT_CULLING);
+            lightClusters.cull(projection, NEAR_PLANE);
+        }
+
+        if (litFeatures() & FEATURE_OBJECT_LIGHTS)
+        {
+            PROFILE_ZONE("Object lights");
+            assignObjectLights(bmw_model_matrix);
+        }
+
+        if (renderPath == DEFERRED_SHADING)
+            renderDeferred(bmw_model_matrix, projection, view);
+        else
+            renderForward(bmw_model_matrix);
+    }
+
+    // what lightmap_baker and probe_baker bake: de_dust2 where it is drawn, and the lights that
+    // never move, the lamps of pointLightPositions, which are the first point lights of lights
+    const Model &staticModel() const
+    {
+        return de_dust2_model;
+    }
+
+    const glm::mat4 &staticModelMatrix() const
+    {
+        return dust2_model_matrix;
+    }
+
+    int staticPointLightCount() const
+    {
+        return (int)std::size(pointLightPositions);
+    }
+
+    // the sun's direction, which the moon shares
+    glm::vec3 staticSunDirection() const
+    {
+        return daylight.direction;
+    }
+
+    std::vector<point_light> staticPointLights() const
+    {
+        std::vector<point_light> staticLights;
+        for (int i = 0; i < staticPointLightCount(); i++)
+            staticLights.push_back(lights.pointLight(i));
+        return staticLights;
+    }
+
+    // the shader_feature bits of the lit shaders for the current state
+    unsigned int litFeatures() const
+    {
+        unsigned int features = 0;
+        if (blinn)
+            features |= FEATURE_BLINN;
+        if (fogIntensity != 0.0f)
+            features |= FEATURE_FOG;
+        if (clustered && renderPath == FORWARD_SHADING)
+        {
+            features |= FEATURE_CLUSTERED;
+            if (clusterHeatmap)
+                features |= FEATURE_HEATMAP;
+        }
+        else if (perObjectLights && renderPath == FORWARD_SHADING)
+            features |= FEATURE_OBJECT_LIGHTS;
+        return features;
+    }
+
+private:
+    unsigned int flagFeatures(unsigned int features) const
+    {
+        return flagTextured ? features | FEATURE_TEXTURED : features;
+    }
+
+    // features of de_dust2's forward shader
+    unsigned int dust2Features(unsigned int features) const
+    {
+        return useLightmap && dust2Lightmap.loaded() && renderPath == FORWARD_SHADING ? features | FEATURE_LIGHTMAP : features;
+    }
+
+    // de_dust2's variants to submit before the models load. The lightmap is only read after
+    // de_dust2, so its variant is submitted whenever the file exists, in case it is not stale.
+    std::vector<unsigned int> dust2Precompile() const
+    {
+        std::vector<unsigned int> masks = { litFeatures() };
+        if (useLightmap && renderPath == FORWARD_SHADING && std::ifstream(DUST2_LIGHTMAP_PATH).good())
+            masks.push_back(litFeatures() | FEATURE_LIGHTMAP);
+        return masks;
+    }
+
+    // lit forward shaders: every object is lit while it is drawn
+    void renderForward(const glm::mat4 &bmw_model_matrix)
+    {
+        unsigned int features = litFeatures();
+        // objectLights is only declared with FEATURE_OBJECT_LIGHTS
+        bool perObject = (features & FEATURE_OBJECT_LIGHTS) != 0;
+        Shader &cubeShader = lightingShader.get(features);
+        Shader::Uniform cubeModelUniform;
+        Shader::Uniform cubeLightsUniform;
+        {
+            PROFILE_ZONE("Material uniforms: cubes");
+            // be sure to activate shader when setting uniforms/drawing objects
+            cubeShader.use();
+            cubeShader.setFloat("shininess", 32.0f);
+
+            // world transformation
+            glm::mat4 model = glm::mat4(1.0f);
+            cubeShader.setMat4("model", model);
+            cubeModelUniform = cubeShader.uniform("model");
+            cubeLightsUniform = cubeShader.uniform("objectLights");
+        }
+
+        {
+            PROFILE_ZONE("Draw cubes");
+            GpuTimer::Scope gpuScope(gpuTimer, GPU_PASS_CUBES);
+            // bind diffuse map
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, diffuseMap);
+            // bind specular map
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, specularMap);
+
+            // render containers
+            glBindVertexArray(cubeVAO);
+            for (unsigned int i = 0; i < 10; i++)
+            {
+                // calculate the model matrix for each object and pass it to shader before drawing
+                cubeShader.setMat4(cubeModelUniform, cubeModelMatrix(i));
+                if (perObject)
+                    cubeShader.setIVec3(cubeLightsUniform, cubeLights[i]);
+
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+        }
+
+        drawLightCubes();
+
+        // bakedPointLights is only declared with FEATURE_LIGHTMAP
+        bool lightmapped = (dust2Features(features) & FEATURE_LIGHTMAP) != 0;
+        Shader &dust2Shader = ourShader.get(dust2Features(features));
+        {
+            PROFILE_ZONE("Material uniforms: de_dust2");
+            dust2Shader.use();
+            dust2Shader.setFloat("shininess", 32.0f);
+            dust2Shader.setMat4("model", dust2_model_matrix);
+            if (lightmapped)
+            {
+                dust2Shader.setInt("bakedPointLights", dust2Lightmap.bakedPointLights);
+                dust2Lightmap.bind();
+            }
+        }
+
+        {
+            PROFILE_ZONE("Draw de_dust2");
+            GpuTimer::Scope gpuScope(gpuTimer, GPU_PASS_DE_DUST2);
+            drawLitModel(de_dust2_model, dust2Shader, perObject ? &dust2Lights : nullptr);
+        }
+
+        Shader &bmwShader = carShader.get(features);
+        {
+            PROFILE_ZONE("Material uniforms: car");
+            bmwShader.use();
+            bmwShader.setFloat("shininess", 32.0f);
+            bmwShader.setFloat("pointDiffuseScale", CAR_POINT_DIFFUSE_SCALE);
+            bmwShader.setMat4("model", bmw_model_matrix);
+        }
+
+        {
+            PROFILE_ZONE("Draw car");
+            GpuTimer::Scope gpuScope(gpuTimer, GPU_PASS_CAR);
+            drawLitModel(bmw_g82_m4_model, bmwShader, perObject ? &carLights : nullptr);
+        }
+
+        {
+            PROFILE_ZONE("Material uniforms: flag");
+            glBindVertexArray(bezierSurfaceVAO);
+
+            // render bezier surface
+            Shader &flagShader = bezierSurfaceShader.get(flagFeatures(features));
+            flagShader.use();
+            flagShader.setMat4("model", flagMatrix);
+            flagShader.setInt("uDegree", rez - 1);
+            flagShader.setInt("vDegree", rez - 1);
+            flagShader.setFloat("shininess", 32.0f);
+            if (perObject)
+                flagShader.setIVec3("objectLights", flagLights);
+            bindFlagMaterial(flagShader);
+        }
+
+        {
+            PROFILE_ZONE("Draw flag");
+            GpuTimer::Scope gpuScope(gpuTimer, GPU_PASS_FLAG);
+            glDrawArrays(GL_PATCHES, 0, rez * rez);
+            glBindVertexArray(0);
+        }
+    }
+
+    // the same objects through DeferredRenderer: G-buffer, light passes, fog composite
+    void renderDeferred(const glm::mat4 &bmw_model_matrix, const glm::mat4 &projection, const glm::mat4 &view)
+    {
+        GLint target = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        {
+            PROFILE_ZONE("G-buffer");
+            deferred.beginGeometry(viewport[2], viewport[3]);
+
+            {
+                GpuTimer::Scope gpuScope(gpuTimer, GPU_PASS_CUBES);
+                gBufferShader.use();
+                gBufferShader.setFloat("shininess", 32.0f);
+                gBufferShader.setBool("specularTexture", true);
+                gBufferShader.setFloat("specularScale", 2.0f);
+                gBufferShader.setFloat("pointDiffuseScale", 1.0f);
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, diffuseMap);
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, specularMap);
+                gBufferShader.setInt("texture_diffuse1", 0);
+                gBufferShader.setInt("texture_specular1", 1);
+
+                glBindVertexArray(cubeVAO);
+                for (unsigned int i = 0; i < 10; i++)
+                {
+                    gBufferShader.setMat4(gBufferModelUniform, cubeModelMatrix(i));
+
+                    glDrawArrays(GL_TRIANGLES, 0, 36);
+                }
+            }
+
+            {
+                GpuTimer::Scope gpuScope(gpuTimer, GPU_PASS_DE_DUST2);
+                gBufferShader.setFloat("specularScale", 1.0f);
+                gBufferShader.setMat4(gBufferModelUniform, dust2_model_matrix);
+                de_dust2_model.Draw(gBufferShader);
+            }
+
+            {
+                GpuTimer::Scope gpuScope(gpuTimer, GPU_PASS_CAR);
+                gBufferShader.setBool("specularTexture", false);
+                gBufferShader.setFloat("pointDiffuseScale", CAR_POINT_DIFFUSE_SCALE);
+                gBufferShader.setMat4(gBufferModelUniform, bmw_model_matrix);
+                bmw_g82_m4_model.Draw(gBufferShader);
+            }
+
+            {
+                GpuTimer::Scope gpuScope(gpuTimer, GPU_PASS_FLAG);
+                glBindVertexArray(bezierSurfaceVAO);
+                Shader &flagShader = gBufferFlagShader.get(flagFeatures(0));
+                flagShader.use();
+                flagShader.setMat4("model", flagMatrix);
+                flagShader.setInt("uDegree", rez - 1);
+                flagShader.setInt("vDegree", rez - 1);
+                flagShader.setFloat("shininess", 32.0f);
+                bindFlagMaterial(flagShader);
+                glDrawArrays(GL_PATCHES, 0, rez * rez);
+                glBindVertexArray(0);
+            }
+        }
+
+        {
+            PROFILE_ZONE("Deferred lighting");
+            GpuTimer::Scope gpuScope(gpuTimer, GPU_PASS_DEFERRED_LIGHTING);
+            deferred.accumulateLights(projection, view, lights.pointLightCount(), lights.spotlightCount(), litFeatures());
+            deferred.composite((GLuint)target, projection, litFeatures());
+        }
+
+        drawLightCubes();
+    }
+
+    glm::mat4 cubeModelMatrix(unsigned int i) const
+    {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model, cubePositions[i]);
+        float angle = 20.0f * i;
+        model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+        return model;
+    }
+
+    // a model lit by the forward shaders; with meshLights each mesh gets its own light list
+    void drawLitModel(Model &model, Shader &shader, const std::vector<glm::ivec3> *meshLights)
+    {
+        if (meshLights == nullptr)
+        {
+            model.Draw(shader);
+            return;
+        }
+        Shader::Uniform lightsUniform = shader.uniform("objectLights");
+        model.Draw(shader, [&](unsigned int mesh) { shader.setIVec3(lightsUniform, (*meshLights)[mesh]); });
+    }
+
+    // the per-object light lists of everything renderForward draws lit, from the bounds of
+    // each container, mesh and the flag
+    void assignObjectLights(const glm::mat4 &bmw_model_matrix)
+    {
+        objectLights.begin(lights);
+        for (unsigned int i = 0; i < 10; i++)
+            cubeLights[i] = objectLights.assign(glm::vec3(-0.5f), glm::vec3(0.5f), cubeModelMatrix(i));
+        assignMeshLights(de_dust2_model, dust2_model_matrix, dust2Lights);
+        assignMeshLights(bmw_g82_m4_model, bmw_model_matrix, carLights);
+
+        // a Bezier surface lies inside the box of its control points
+        glm::vec3 flagMin = bezierSurfaceVertices[0][0].position;
+        glm::vec3 flagMax = flagMin;
+        for (const auto &row : bezierSurfaceVertices)
+            for (const bezierSurfaceVertex &vertex : row)
+            {
+                flagMin = glm::min(flagMin, vertex.position);
+                flagMax = glm::max(flagMax, vertex.position);
+            }
+        flagLights = objectLights.assign(flagMin, flagMax, flagMatrix);
+        objectLights.upload();
+    }
+
+    void assignMeshLights(const Model &model, const glm::mat4 &modelMatrix, std::vector<glm::ivec3> &meshLights)
+    {
+        meshLights.resize(model.meshes.size());
+        for (size_t i = 0; i < model.meshes.size(); i++)
+            meshLights[i] = objectLights.assign(model.meshes[i].boundsMin, model.meshes[i].boundsMax, modelMatrix);
+    }
+
+    // depth only, for the shadow maps: de_dust2 is the static caster; the containers (through the
+    // light cube VAO, which only has the position attribute), the car and the flag are dynamic
+    void drawShadowCasters(const glm::mat4 &lightSpace, const glm::mat4 &bmw_model_matrix, unsigned int casters)
+    {
+        shadowDepthShader.use();
+        shadowDepthShader.setMat4(shadowDepthLightSpaceUniform, lightSpace);
+        if (casters & STATIC_CASTERS)
+        {
+            shadowDepthShader.setMat4(shadowDepthModelUniform, dust2_model_matrix);
+            de_dust2_model.DrawPositions();
+        }
+        if (!(casters & DYNAMIC_CASTERS))
+            return;
+
+        glBindVertexArray(lightCubeVAO);
+        for (unsigned int i = 0; i < 10; i++)
+        {
+            shadowDepthShader.setMat4(shadowDepthModelUniform, cubeModelMatrix(i));
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        }
+        glBindVertexArray(0);
+        shadowDepthShader.setMat4(shadowDepthModelUniform, bmw_model_matrix);
+        bmw_g82_m4_model.DrawPositions();
+
+        flagDepthShader.use();
+        flagDepthShader.setMat4("lightSpace", lightSpace);
+        flagDepthShader.setMat4("model", flagMatrix);
+        flagDepthShader.setInt("uDegree", rez - 1);
+        flagDepthShader.setInt("vDegree", rez - 1);
+        glBindVertexArray(bezierSurfaceVAO);
+        glDrawArrays(GL_PATCHES, 0, rez * rez);
+        glBindVertexArray(0);
+    }
+
+    // the container's maps on units 0 and 1, or the flat grey material
+    void bindFlagMaterial(Shader &shader)
+    {
+        if (flagTextured)
+        {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, diffuseMap);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, specularMap);
+        }
+        else
+        {
+            shader.setVec3("material_diffuse", glm::vec3(0.5f, 0.5f, 0.5f));
+            shader.setVec3("material_specular", glm::vec3(0.5f, 0.5f, 0.5f));
+        }
+    }
+
+    void drawLightCubes()
+    {
+        {
+            PROFILE_ZONE("Draw light cubes");
+            GpuTimer::Scope gpuScope(gpuTimer, GPU_PASS_LIGHT_CUBES);
+            // also draw the lamp object(s)
+            lightCubeShader.use();
+
+            // we now draw as many light bulbs as we have point lights.
+            glBindVertexArray(lightCubeVAO);
+            for (int i = 0; i < lights.pointLightCount(); i++)
+            {
+                glm::mat4 model = glm::mat4(1.0f);
+                model = glm::translate(model, lights.pointLight(i).position);
+                model = glm::scale(model, glm::vec3(0.2f)); // Make it a smaller cube
+                lightCubeShader.setMat4(lightCubeModelUniform, model);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+            glBindVertexArray(0);
+        }
+    }
+
+    dir_light daylight;
+    dir_light night_light;
+    dir_light active_light;
+
+    // positions all containers
+    glm::vec3 cubePositions[10] = {
+        glm::vec3(15.0f, 3.0f, -19.0f),
+        glm::vec3(12.0f,  5.0f, -8.0f),
+        glm::vec3(9.0f, -2.2f, -6.0f),
+        glm::vec3(2.0f, 0.0f, -24.0f),
+        glm::vec3(2.4f, -0.4f, -3.5f),
+        glm::vec3(-1.7f,  3.0f, -7.5f),
+        glm::vec3(1.3f, -2.0f, -2.5f),
+        glm::vec3(1.5f,  2.0f, -2.5f),
+        glm::vec3(1.5f,  0.2f, -1.5f),
+        glm::vec3(-1.3f,  1.0f, -1.5f)
+    };
+
+    // positions of the point lights
+    glm::vec3 pointLightPositions[2] = {
+        glm::vec3(16.0f, 3.0f, -19.0f),
+        glm::vec3(5.0f, 0.5f, -25.0f)
+    };
+    // indices of the car's headlights in lights
+    int headlights[2];
+
+    // this frame's per-object light lists (assignObjectLights)
+    glm::ivec3 cubeLights[10];
+    std::vector<glm::ivec3> dust2Lights;
+    std::vector<glm::ivec3> carLights;
+    glm::ivec3 flagLights;
+
+    UniformBuffer<camera_block> cameraBuffer;
+    UniformBuffer<lighting_block> lightingBuffer;
+
+    unsigned int VBO, cubeVAO, lightCubeVAO;
+    unsigned int diffuseMap, specularMap;
+
+    glm::mat4 dust2_model_matrix;
+    glm::mat4 flagMatrix;
+
+    bezierSurfaceVertex bezierSurfaceVertices[rez][rez] = {};
+    unsigned int bezierSurfaceVBO, bezierSurfaceVAO;
+
+    Shader::Uniform lightCubeModelUniform;
+    Shader::Uniform gBufferModelUniform;
+    Shader::Uniform shadowDepthModelUniform;
+    Shader::Uniform shadowDepthLightSpaceUniform;
+};
+
+// utility function for loading a 2D texture from file
+// ---------------------------------------------------
+inline unsigned int loadTexture(char const *path)
+{
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+
+    int width, height, nrComponents;
+    unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
+    if (data)
+    {
+        // stb_image gives 1 to 4 components
+        GLenum format = GL_RGBA;
+        if (nrComponents == 1)
+            format = GL_RED;
+        else if (nrComponents == 2)
+            format = GL_RG;
+        else if (nrComponents == 3)
+            format = GL_RGB;
+
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        stbi_image_free(data);
+    }
+    else
+    {
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+        stbi_image_free(data);
+    }
+
+    return textureID;
+}
+
+#endif
@@ -0,0 +1,74 @@
+// Light structs and the per-frame blocks shared by every scene shader (see uniform_blocks.h
+// for the C++ side). Included with #include "scene_blocks.glsl".
+
+struct DirLight {
+    vec3 direction;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct PointLight {
+    vec3 position;
+
+    float constant;
+    float linear;
+    float quadratic;
+    float radius; // where the light stops mattering, for clustering
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct SpotLight {
+    vec3 position;
+    float radius;
+    vec3 direction;
+    float cutOff;
+    float outerCutOff;
+
+    float constant;
+    float linear;
+    float quadratic;
+
+    vec3 ambient;
+    int shadowLayer; // layer of spotShadowMap, -1: casts no shadows
+    vec3 diffuse;
+    vec3 specular;
+};
+
+// per-frame state shared by all scene shaders, uploaded once per frame
+layout (std140, binding = 0) uniform Camera
+{
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
+
+layout (std140, binding = 1) uniform Lighting
+{
+    DirLight dirLight;
+    vec3 fogColor;
+    float fogIntensity;
+    int pointLightCount;
+    int spotLightCount;
+    vec2 screenSize;
+    ivec4 clusterGrid; // x, y, z, lights per cluster
+    float clusterScale;
+    float clusterNear;
+    vec4 probeGridOrigin; // xyz: the first probe, w: the spacing
+    ivec4 probeGridSize;  // probes along x, y, z; w 0: no probes, flat ambient
+};
+
+// any number of lights, sized at runtime by LightRegistry
+layout (std430, binding = 2) readonly buffer PointLights
+{
+    PointLight pointLights[];
+};
+
+layout (std430, binding = 3) readonly buffer SpotLights
+{
+    SpotLight spotLights[];
+};
@@ -0,0 +1,22 @@
+#ifndef SHADER_FEATURES_H
+#define SHADER_FEATURES_H
+
+#include <string>
+#include <vector>
+
+// Compile-time features of the lit shaders, one ShaderVariants bit each. SHADER_FEATURES holds
+// the #define each bit turns on, in bit order.
+enum shader_feature : unsigned int
+{
+    FEATURE_BLINN = 1u << 0,        // Blinn-Phong instead of Phong specular
+    FEATURE_FOG = 1u << 1,          // distance fog; off while the fog intensity is 0
+    FEATURE_CLUSTERED = 1u << 2,    // only the lights of the fragment's froxel (light_clusters.h)
+    FEATURE_HEATMAP = 1u << 3,      // with FEATURE_CLUSTERED: the froxel's light count instead of the lit colour
+    FEATURE_TEXTURED = 1u << 4,     // bezier flag: diffuse and specular maps instead of a flat material
+    FEATURE_OBJECT_LIGHTS = 1u << 5, // only the lights whose range reaches the drawn object (object_lights.h)
+    FEATURE_LIGHTMAP = 1u << 6       // 1.model_loading: the static lights and ambient occlusion from a lightmap (lightmap.h)
+};
+
+inline const std::vector<std::string> SHADER_FEATURES = { "BLINN", "FOG", "CLUSTERED", "HEATMAP", "TEXTURED", "OBJECT_LIGHTS", "LIGHTMAP" };
+
+#endif
@@ -0,0 +1,295 @@
+#ifndef SHADOW_CASCADES_H
+#define SHADOW_CASCADES_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/gpu_timer.h>
+#include <learnopengl/uniform_buffer.h>
+
+#include "uniform_blocks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+
+// Cascaded shadow maps for the directional light (the sun by day, the moon by night).
+// The camera's view distance up to maxDistance is split into cascadeCount slices, near ones
+// short and far ones long (splitLambda blends logarithmic and uniform splits). Each slice gets
+// its own layer of a depth array texture, rendered with an orthographic projection along the
+// light that encloses the slice's bounding sphere:
+// - a sphere does not change size as the camera turns, and the box only moves in whole shadow
+//   map texels, so static shadow edges do not shimmer while the camera moves;
+// - the depth pass only fetches positions (Mesh::DrawPositions) and runs with depth clamping,
+//   so casters between the light and the box still cast;
+// - shadows.glsl samples the cascade of the fragment's view distance with PCF, every tap a
+//   hardware 2x2 comparison.
+// The cachedCascades farthest cascades cover most of the scene at the lowest detail; they are
+// only re-rendered every cacheInterval frames, staggered so they do not all fall on one frame,
+// and at once when the light turns, the settings change or the camera's slice leaves the box
+// they were fitted to. Moving casters (the car) lag behind in them by up to cacheInterval
+// frames. While the pass's measured GPU time (measuredMs, from the caller's GpuTimer) is over
+// budgetMs, a cached cascade that is only due by the interval waits, up to another interval.
+class ShadowCascades
+{
+public:
+    // draws every shadow caster depth-only, transformed by lightSpace (light projection * view)
+    typedef std::function<void(const glm::mat4 &lightSpace)> DrawCasters;
+
+    // settings, applied by the next render()
+    bool enabled;
+    int cascadeCount;    // 1 .. MAX_SHADOW_CASCADES
+    int resolution;      // width and height of every cascade's map
+    int cachedCascades;  // how many of the farthest cascades are cached, 0 .. cascadeCount - 1
+    int cacheInterval;   // frames between re-renders of a cached cascade
+    int pcfRadius;       // 0: one tap, 1: 3x3 taps, 2: 5x5 taps
+    float maxDistance;   // view distance where the last cascade ends
+    float splitLambda;   // 0: uniform splits, 1: logarithmic splits
+    float budgetMs;      // GPU time of the pass before due cached cascades wait, 0: no budget
+
+    // GPU time of the pass as the caller measured it, 0 while unknown
+    float measuredMs;
+
+    // cascades the last render() drew, and the due cached ones it left for later
+    int renderedCascades;
+    int deferredCascades;
+
+    ShadowCascades()
+        : enabled(true), cascadeCount(4), resolution(1024), cachedCascades(2), cacheInterval(4), pcfRadius(1),
+          maxDistance(50.0f), splitLambda(0.75f), budgetMs(2.0f), measuredMs(0.0f), renderedCascades(0),
+          deferredCascades(0),
+          blockBuffer(SHADOWS_BLOCK_BINDING),
+          shadowMap(0), mapCascades(0), mapResolution(0)
+    {
+        glGenFramebuffers(1, &framebuffer);
+    }
+
+    ~ShadowCascades()
+    {
+        glDeleteFramebuffers(1, &framebuffer);
+        if (shadowMap != 0)
+            glDeleteTextures(1, &shadowMap);
+    }
+
+    ShadowCascades(const ShadowCascades &) = delete;
+    ShadowCascades &operator=(const ShadowCascades &) = delete;
+
+    // fits the cascades to the camera, renders those that are due and uploads the Shadows block.
+    // view, fovy (radians), aspect and zNear describe the camera's frustum; lightDirection points
+    // from the light into the scene. Leaves the previous framebuffer and viewport bound.
+    void render(const glm::mat4 &view, float fovy, float aspect, float zNear, glm::vec3 lightDirection,
+                const DrawCasters &drawCasters)
+    {
+        renderedCascades = 0;
+        deferredCascades = 0;
+        shadows_block block = {};
+        if (!enabled)
+        {
+            for (bool &valid : cascadeValid)
+                valid = false;
+            blockBuffer.upload(block);
+            return;
+        }
+
+        cascadeCount = std::clamp(cascadeCount, 1, MAX_SHADOW_CASCADES);
+        cachedCascades = std::clamp(cachedCascades, 0, cascadeCount - 1);
+        cacheInterval = std::max(cacheInterval, 1);
+        pcfRadius = std::clamp(pcfRadius, 0, 2);
+
+        GLint target = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        if (cascadeCount != mapCascades || resolution != mapResolution)
+            createMap();
+
+        lightDirection = glm::normalize(lightDirection);
+        if (glm::length(lightDirection - renderedDirection) > 1e-5f)
+        {
+            renderedDirection = lightDirection;
+            for (bool &valid : cascadeValid)
+                valid = false;
+        }
+        glm::vec3 up = std::abs(lightDirection.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), lightDirection, up);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(0, 0, resolution, resolution);
+        glEnable(GL_DEPTH_CLAMP);
+        // slope-scaled bias, the shader adds a normal offset
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(1.0f, 1.0f);
+
+        // the GPU time of one cascade, from the time of the pass and how many it drew on average
+        float cascadeMs = averageRendered > 0.0f ? measuredMs / averageRendered : 0.0f;
+        int firstCached = cascadeCount - cachedCascades;
+        float sliceNear = zNear;
+        for (int i = 0; i < cascadeCount; i++)
+        {
+            float sliceFar = splitDistance(i + 1, zNear);
+            block.cascadeSplits[i] = sliceFar;
+            bool cached = i >= firstCached;
+            glm::mat4 inverseSlice = glm::inverse(glm::perspective(fovy, aspect, sliceNear, sliceFar) * view);
+            if (cached && cascadeValid[i] && covers(cascadeMatrices[i], inverseSlice))
+            {
+                bool due = ++framesSinceRender[i] >= cacheInterval;
+                bool deferred = due && framesSinceRender[i] < 2 * cacheInterval && budgetMs > 0.0f
+                                && (renderedCascades + 1) * cascadeMs > budgetMs;
+                if (!due || deferred)
+                {
+                    if (deferred)
+                        deferredCascades++;
+                    sliceNear = sliceFar;
+                    continue;
+                }
+            }
+            // a cascade rendered out of turn restarts the stagger: cached cascade k is due k frames early
+            framesSinceRender[i] = cached && !cascadeValid[i] ? (i - firstCached) % cacheInterval : 0;
+            cascadeValid[i] = true;
+
+            glm::mat4 lightSpace = fitCascade(inverseSlice, lightView, texelSizes[i]);
+            // clip space [-1, 1] to texture space [0, 1]
+            glm::mat4 toTexture = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.5f)), glm::vec3(0.5f));
+            cascadeMatrices[i] = toTexture * lightSpace;
+
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowMap, 0, i);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            drawCasters(lightSpace);
+            renderedCascades++;
+            sliceNear = sliceFar;
+        }
+
+        averageRendered += (renderedCascades - averageRendered) / GpuTimer::HISTORY;
+
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        glDisable(GL_DEPTH_CLAMP);
+        glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)target);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+        for (int i = 0; i < cascadeCount; i++)
+        {
+            block.cascadeMatrices[i] = cascadeMatrices[i];
+            block.cascadeTexelSizes[i] = texelSizes[i];
+        }
+        block.cascadeCount = cascadeCount;
+        block.pcfRadius = pcfRadius;
+        blockBuffer.upload(block);
+
+        glActiveTexture(GL_TEXTURE0 + SHADOW_MAP_UNIT);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, shadowMap);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    size_t gpuBytes() const
+    {
+        // 32-bit depth
+        return (size_t)mapResolution * mapResolution * mapCascades * 4;
+    }
+
+private:
+    UniformBuffer<shadows_block> blockBuffer;
+    GLuint framebuffer;
+    GLuint shadowMap;
+    // size of shadowMap
+    int mapCascades, mapResolution;
+
+    // as last rendered; a cached cascade keeps the matrix it was rendered with
+    glm::mat4 cascadeMatrices[MAX_SHADOW_CASCADES];
+    float texelSizes[MAX_SHADOW_CASCADES] = {};
+    bool cascadeValid[MAX_SHADOW_CASCADES] = {};
+    int framesSinceRender[MAX_SHADOW_CASCADES] = {};
+    glm::vec3 renderedDirection = glm::vec3(0.0f);
+    // cascades drawn per render(), a rolling average over about as many frames as GpuTimer's
+    float averageRendered = 0.0f;
+
+    // view distance where cascade index - 1 ends and cascade index begins
+    float splitDistance(int index, float zNear) const
+    {
+        float t = (float)index / cascadeCount;
+        float logarithmic = zNear * std::pow(maxDistance / zNear, t);
+        float uniform = zNear + (maxDistance - zNear) * t;
+        return splitLambda * logarithmic + (1.0f - splitLambda) * uniform;
+    }
+
+    // light projection * lightView enclosing the slice whose clip space inverseSlice maps to
+    // world space; texelSize receives the world size of one texel
+    glm::mat4 fitCascade(const glm::mat4 &inverseSlice, const glm::mat4 &lightView, float &texelSize) const
+    {
+        glm::vec3 corners[8];
+        glm::vec3 center(0.0f);
+        for (int i = 0; i < 8; i++)
+        {
+            glm::vec4 corner = inverseSlice * glm::vec4(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f, 1.0f);
+            corners[i] = glm::vec3(corner) / corner.w;
+            center += corners[i] / 8.0f;
+        }
+        float radius = 0.0f;
+        for (const glm::vec3 &corner : corners)
+            radius = std::max(radius, glm::length(corner - center));
+        // rounded up so float noise in the corners does not rescale the map every frame
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+        texelSize = 2.0f * radius / resolution;
+
+        // texel snapping: the box only moves in whole texels across the light's view plane
+        glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+        lightCenter.x = std::floor(lightCenter.x / texelSize) * texelSize;
+        lightCenter.y = std::floor(lightCenter.y / texelSize) * texelSize;
+        glm::mat4 projection = glm::ortho(lightCenter.x - radius, lightCenter.x + radius,
+                                          lightCenter.y - radius, lightCenter.y + radius,
+                                          -lightCenter.z - radius, -lightCenter.z + radius);
+        return projection * lightView;
+    }
+
+    // whether the box of a cascade, cascadeMatrix as last rendered, still holds the slice whose
+    // clip space inverseSlice maps to world space. The texel snapping may move the box by up to
+    // a texel off the bounding sphere, so that much is tolerated.
+    bool covers(const glm::mat4 &cascadeMatrix, const glm::mat4 &inverseSlice) const
+    {
+        float margin = 1.0f / resolution;
+        for (int i = 0; i < 8; i++)
+        {
+            glm::vec4 corner = inverseSlice * glm::vec4(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f, 1.0f);
+            glm::vec3 coords = glm::vec3(cascadeMatrix * glm::vec4(glm::vec3(corner) / corner.w, 1.0f));
+            if (glm::any(glm::lessThan(coords, glm::vec3(-margin))) || glm::any(glm::greaterThan(coords, glm::vec3(1.0f + margin))))
+                return false;
+        }
+        return true;
+    }
+
+    void createMap()
+    {
+        if (shadowMap != 0)
+            glDeleteTextures(1, &shadowMap);
+        mapCascades = cascadeCount;
+        mapResolution = resolution;
+        for (bool &valid : cascadeValid)
+            valid = false;
+
+        glGenTextures(1, &shadowMap);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, shadowMap);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, resolution, resolution, cascadeCount, 0,
+                     GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        // linear filtering with a compare mode: each lookup is a bilinear 2x2 PCF
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowMap, 0, 0);
+        // depth only
+        const GLenum none = GL_NONE;
+        glDrawBuffers(1, &none);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::SHADOWS::FRAMEBUFFER_INCOMPLETE" << std::endl;
+    }
+};
+
+#endif
@@ -0,0 +1,5 @@
+#version 460 core
+// the shadow maps only keep depth
+void main()
+{
+}
@@ -0,0 +1,13 @@
+#version 460 core
+// Depth-only pass of the shadow maps (shadow_cascades.h, spot_shadows.h): positions only, drawn
+// through Mesh::positionsVAO or the cube VAO.
+layout (location = 0) in vec3 aPos;
+
+layout (location = 0) uniform mat4 model;
+// the light's projection * view
+layout (location = 1) uniform mat4 lightSpace;
+
+void main()
+{
+    gl_Position = lightSpace * model * vec4(aPos, 1.0);
+}
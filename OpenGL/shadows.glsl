@@ -0,0 +1,87 @@
+// Cascaded shadow maps of the sun/moon, rendered by shadow_cascades.h, and the shadow maps of
+// the car's headlights, rendered by spot_shadows.h. Included by lighting.glsl.
+#include "scene_blocks.glsl"
+
+layout (std140, binding = 2) uniform Shadows
+{
+    mat4 cascadeMatrices[4]; // world to shadow map texture space, [0, 1] in x, y and depth
+    vec4 cascadeSplits;      // view distance where each cascade ends
+    vec4 cascadeTexelSizes;  // world size of one shadow map texel of each cascade
+    int cascadeCount;        // 0: no shadows
+    int pcfRadius;           // (2 * pcfRadius + 1)^2 taps
+};
+
+// one layer per cascade; comparison sampling filters every tap over 2x2 texels
+layout (binding = 8) uniform sampler2DArrayShadow shadowMap;
+
+// fraction of the sun's light reaching a fragment: 1 lit, 0 in shadow
+float CalcSunShadow(vec3 fragPos, vec3 normal)
+{
+    if (cascadeCount == 0)
+        return 1.0;
+    float depth = -(view * vec4(fragPos, 1.0)).z;
+    int cascade = 0;
+    while (cascade < cascadeCount && depth > cascadeSplits[cascade])
+        cascade++;
+    // beyond the last cascade the sun is not shadowed
+    if (cascade == cascadeCount)
+        return 1.0;
+    // the far cascades are cached and were fitted to an older view, so a fragment may lie
+    // outside its own cascade: the next one covers more. Outside all of them the edge of the
+    // last one is the best guess, fully lit would pop.
+    vec3 coords;
+    for (; cascade < cascadeCount; cascade++)
+    {
+        // normal offset against shadow acne, about a texel of this cascade
+        vec3 offsetPos = fragPos + normal * (1.5 * cascadeTexelSizes[cascade]);
+        coords = (cascadeMatrices[cascade] * vec4(offsetPos, 1.0)).xyz;
+        if (all(greaterThanEqual(coords, vec3(0.0))) && all(lessThanEqual(coords, vec3(1.0))))
+            break;
+    }
+    if (cascade == cascadeCount)
+    {
+        cascade = cascadeCount - 1;
+        coords = clamp(coords, vec3(0.0), vec3(1.0));
+    }
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float lit = 0.0;
+    for (int x = -pcfRadius; x <= pcfRadius; x++)
+        for (int y = -pcfRadius; y <= pcfRadius; y++)
+            lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * texel, float(cascade), coords.z));
+    float taps = float(2 * pcfRadius + 1);
+    return lit / (taps * taps);
+}
+
+layout (std140, binding = 3) uniform SpotShadows
+{
+    mat4 spotShadowMatrices[2]; // world to shadow map texture space, before the divide by w
+    float spotShadowTexelScale; // world size of one texel per unit of distance from the light
+    int spotShadowCount;        // 0: no shadows
+};
+
+// one layer per shadowed spotlight (SpotLight.shadowLayer)
+layout (binding = 9) uniform sampler2DArrayShadow spotShadowMap;
+
+// fraction of a spotlight's light reaching a fragment: 1 lit, 0 in shadow
+float CalcSpotShadow(SpotLight light, vec3 fragPos, vec3 normal)
+{
+    if (light.shadowLayer < 0 || light.shadowLayer >= spotShadowCount)
+        return 1.0;
+    // normal offset against shadow acne; perspective texels grow with the distance
+    float distance = length(light.position - fragPos);
+    vec3 offsetPos = fragPos + normal * (1.5 * spotShadowTexelScale * distance);
+    vec4 clip = spotShadowMatrices[light.shadowLayer] * vec4(offsetPos, 1.0);
+    if (clip.w <= 0.0)
+        return 1.0;
+    vec3 coords = clip.xyz / clip.w;
+    // outside the map's cone the spotlight's falloff leaves nothing to shadow
+    if (any(lessThan(coords, vec3(0.0))) || any(greaterThan(coords, vec3(1.0))))
+        return 1.0;
+    // 3x3 taps
+    vec2 texel = 1.0 / vec2(textureSize(spotShadowMap, 0).xy);
+    float lit = 0.0;
+    for (int x = -1; x <= 1; x++)
+        for (int y = -1; y <= 1; y++)
+            lit += texture(spotShadowMap, vec4(coords.xy + vec2(x, y) * texel, float(light.shadowLayer), coords.z));
+    return lit / 9.0;
+}
@@ -0,0 +1,215 @@
+#ifndef SPOT_SHADOWS_H
+#define SPOT_SHADOWS_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/uniform_buffer.h>
+
+#include "light_registry.h"
+#include "uniform_blocks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+
+// Shadow maps of the spotlights with a shadowLayer (the car's headlights), one perspective depth
+// map per light covering fieldOfView around its direction. Most of what they light is de_dust2,
+// which never moves, so each light keeps two layers:
+// - staticMap holds the static casters only. It is rendered with the light's position and
+//   direction at that time and kept until the light moves more than moveThreshold or turns more
+//   than turnThreshold, so a parked car never redraws the level;
+// - every frame the static layer is copied into shadowMap (glCopyImageSubData) and the dynamic
+//   casters are drawn on top with the same matrix.
+// Until the light passes a threshold the map is seen from where the light was, off by at most
+// the thresholds. The lamps sit inside the car's body, so the maps start at nearPlane, in front
+// of the bumper. shadows.glsl looks the maps up in CalcSpotLight with 3x3 PCF.
+class SpotShadows
+{
+public:
+    // draws shadow casters depth-only, transformed by lightSpace (light projection * view)
+    typedef std::function<void(const glm::mat4 &lightSpace)> DrawCasters;
+
+    // settings, applied by the next render()
+    bool enabled;
+    bool cacheStatic;    // false: redraw the static casters every frame
+    int resolution;      // width and height of every light's map
+    float fieldOfView;   // degrees; pow(cos, 32) falloff leaves under 1/500 of the light outside 70
+    float nearPlane;
+    float moveThreshold; // distance the light may move before its static map is redrawn
+    float turnThreshold; // degrees the light may turn before its static map is redrawn
+
+    // static maps the last render() redrew
+    int staticRenders;
+
+    SpotShadows()
+        : enabled(true), cacheStatic(true), resolution(1024), fieldOfView(70.0f), nearPlane(1.0f),
+          moveThreshold(0.05f), turnThreshold(0.5f), staticRenders(0),
+          blockBuffer(SPOT_SHADOWS_BLOCK_BINDING),
+          staticMap(0), shadowMap(0), mapResolution(0)
+    {
+        glGenFramebuffers(1, &framebuffer);
+    }
+
+    ~SpotShadows()
+    {
+        glDeleteFramebuffers(1, &framebuffer);
+        if (shadowMap != 0)
+        {
+            glDeleteTextures(1, &staticMap);
+            glDeleteTextures(1, &shadowMap);
+        }
+    }
+
+    SpotShadows(const SpotShadows &) = delete;
+    SpotShadows &operator=(const SpotShadows &) = delete;
+
+    // renders the map of every spotlight of lights with a shadowLayer and uploads the
+    // SpotShadows block. Leaves the previous framebuffer and viewport bound.
+    void render(LightRegistry &lights, const DrawCasters &drawStatic, const DrawCasters &drawDynamic)
+    {
+        staticRenders = 0;
+        spot_shadows_block block = {};
+        if (!enabled)
+        {
+            for (bool &valid : staticValid)
+                valid = false;
+            blockBuffer.upload(block);
+            return;
+        }
+
+        GLint target = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        if (resolution != mapResolution)
+            createMaps();
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(0, 0, resolution, resolution);
+        // slope-scaled bias, the shader adds a normal offset
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(1.0f, 1.0f);
+
+        float turnCos = std::cos(glm::radians(turnThreshold));
+        for (int i = 0; i < lights.spotlightCount(); i++)
+        {
+            const spotlight &light = lights.spotLight(i);
+            int layer = light.shadowLayer;
+            if (layer < 0 || layer >= MAX_SHADOWED_SPOTLIGHTS)
+                continue;
+            glm::vec3 direction = glm::normalize(light.direction);
+            bool moved = glm::length(light.position - renderedPositions[layer]) > moveThreshold ||
+                         glm::dot(direction, renderedDirections[layer]) < turnCos;
+            if (!staticValid[layer] || moved || !cacheStatic)
+            {
+                renderedPositions[layer] = light.position;
+                renderedDirections[layer] = direction;
+                lightSpaces[layer] = lightSpace(light.position, direction, light.range());
+                staticValid[layer] = cacheStatic;
+
+                glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, cacheStatic ? staticMap : shadowMap, 0, layer);
+                glClear(GL_DEPTH_BUFFER_BIT);
+                drawStatic(lightSpaces[layer]);
+                staticRenders++;
+            }
+
+            if (cacheStatic)
+                glCopyImageSubData(staticMap, GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer,
+                                   shadowMap, GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, resolution, resolution, 1);
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowMap, 0, layer);
+            drawDynamic(lightSpaces[layer]);
+
+            // clip space [-1, 1] to texture space [0, 1]; the shader divides by w
+            glm::mat4 toTexture = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.5f)), glm::vec3(0.5f));
+            block.spotShadowMatrices[layer] = toTexture * lightSpaces[layer];
+            block.spotShadowCount = std::max(block.spotShadowCount, layer + 1);
+        }
+
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)target);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+        block.spotShadowTexelScale = 2.0f * std::tan(glm::radians(fieldOfView) / 2.0f) / resolution;
+        blockBuffer.upload(block);
+
+        glActiveTexture(GL_TEXTURE0 + SPOT_SHADOW_MAP_UNIT);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, shadowMap);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    size_t gpuBytes() const
+    {
+        // 32-bit depth, static and final layers
+        return (size_t)mapResolution * mapResolution * MAX_SHADOWED_SPOTLIGHTS * 4 * 2;
+    }
+
+private:
+    UniformBuffer<spot_shadows_block> blockBuffer;
+    GLuint framebuffer;
+    GLuint staticMap, shadowMap;
+    // size of the maps
+    int mapResolution;
+
+    // the light as its static layer was rendered
+    glm::vec3 renderedPositions[MAX_SHADOWED_SPOTLIGHTS] = {};
+    glm::vec3 renderedDirections[MAX_SHADOWED_SPOTLIGHTS] = {};
+    glm::mat4 lightSpaces[MAX_SHADOWED_SPOTLIGHTS];
+    bool staticValid[MAX_SHADOWED_SPOTLIGHTS] = {};
+
+    // light projection * view of a spotlight at position shining along direction, up to range
+    glm::mat4 lightSpace(const glm::vec3 &position, const glm::vec3 &direction, float range) const
+    {
+        glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::mat4 view = glm::lookAt(position, position + direction, up);
+        float farPlane = std::max(range, nearPlane + 1.0f);
+        return glm::perspective(glm::radians(fieldOfView), 1.0f, nearPlane, farPlane) * view;
+    }
+
+    // one layer per shadowed spotlight in each map
+    GLuint createMap()
+    {
+        GLuint map;
+        glGenTextures(1, &map);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, map);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, resolution, resolution, MAX_SHADOWED_SPOTLIGHTS, 0,
+                     GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        // linear filtering with a compare mode: each lookup is a bilinear 2x2 PCF
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        return map;
+    }
+
+    void createMaps()
+    {
+        if (shadowMap != 0)
+        {
+            glDeleteTextures(1, &staticMap);
+            glDeleteTextures(1, &shadowMap);
+        }
+        mapResolution = resolution;
+        for (bool &valid : staticValid)
+            valid = false;
+        staticMap = createMap();
+        shadowMap = createMap();
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowMap, 0, 0);
+        // depth only
+        const GLenum none = GL_NONE;
+        glDrawBuffers(1, &none);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::SPOT_SHADOWS::FRAMEBUFFER_INCOMPLETE" << std::endl;
+    }
+};
+
+#endif
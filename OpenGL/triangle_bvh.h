@@ -0,0 +1,240 @@
+#ifndef TRIANGLE_BVH_H
+#define TRIANGLE_BVH_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Bounding volume hierarchy over a static triangle soup, for the lightmap baker's shadow and
+// occlusion rays and the probe baker's closest hits. Nodes split the triangles at the median of
+// their centroids along the longest axis until at most LEAF_SIZE remain; each node stores its
+// box and either its children or its range of triangles. Built once, then only read, so any
+// number of threads may trace at a time.
+class TriangleBvh
+{
+public:
+    struct Triangle
+    {
+        glm::vec3 a, b, c;
+    };
+
+    // the closest triangle on a ray: its index in the soup given to the constructor, the distance
+    // along the ray and the barycentric weights of b and c at the hit
+    struct Hit
+    {
+        unsigned int triangle;
+        float distance;
+        float u, v;
+    };
+
+    // rays closer to parallel with a triangle than this miss it (Moller-Trumbore determinant)
+    static constexpr float EPSILON = 1e-12f;
+    static const int LEAF_SIZE = 4;
+
+    explicit TriangleBvh(std::vector<Triangle> triangles)
+        : triangles(std::move(triangles))
+    {
+        if (this->triangles.empty())
+            return;
+        std::vector<glm::vec3> centroids;
+        centroids.reserve(this->triangles.size());
+        for (const Triangle &triangle : this->triangles)
+            centroids.push_back((triangle.a + triangle.b + triangle.c) / 3.0f);
+        std::vector<unsigned int> order(this->triangles.size());
+        for (unsigned int i = 0; i < order.size(); i++)
+            order[i] = i;
+        nodes.reserve(this->triangles.size() * 2 / LEAF_SIZE + 1);
+        build(order, centroids, 0, (unsigned int)order.size());
+
+        // leaves index the triangles in order
+        std::vector<Triangle> sorted;
+        sorted.reserve(order.size());
+        for (unsigned int index : order)
+            sorted.push_back(this->triangles[index]);
+        this->triangles.swap(sorted);
+        ids.swap(order);
+    }
+
+    size_t triangleCount() const
+    {
+        return triangles.size();
+    }
+
+    size_t nodeCount() const
+    {
+        return nodes.size();
+    }
+
+    // whether anything lies on the ray from origin along the unit direction closer than maxDistance
+    bool occluded(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance) const
+    {
+        if (nodes.empty())
+            return false;
+        glm::vec3 inverse = 1.0f / direction;
+        unsigned int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            const Node &node = nodes[stack[--top]];
+            if (!rayHitsBox(origin, inverse, maxDistance, node.boxMin, node.boxMax))
+                continue;
+            if (node.count > 0)
+            {
+                for (unsigned int i = node.first; i < node.first + node.count; i++)
+                {
+                    Hit hit;
+                    if (rayHitsTriangle(origin, direction, maxDistance, triangles[i], hit))
+                        return true;
+                }
+            }
+            else
+            {
+                stack[top++] = node.first;
+                stack[top++] = node.second;
+            }
+        }
+        return false;
+    }
+
+    // the closest triangle on the ray from origin along the unit direction within maxDistance;
+    // false if there is none
+    bool intersect(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, Hit &closest) const
+    {
+        if (nodes.empty())
+            return false;
+        glm::vec3 inverse = 1.0f / direction;
+        bool found = false;
+        unsigned int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            const Node &node = nodes[stack[--top]];
+            // boxes behind the closest hit so far cannot hold a closer one
+            if (!rayHitsBox(origin, inverse, maxDistance, node.boxMin, node.boxMax))
+                continue;
+            if (node.count > 0)
+            {
+                for (unsigned int i = node.first; i < node.first + node.count; i++)
+                {
+                    Hit hit;
+                    if (rayHitsTriangle(origin, direction, maxDistance, triangles[i], hit))
+                    {
+                        hit.triangle = ids[i];
+                        closest = hit;
+                        maxDistance = hit.distance;
+                        found = true;
+                    }
+                }
+            }
+            else
+            {
+                stack[top++] = node.first;
+                stack[top++] = node.second;
+            }
+        }
+        return found;
+    }
+
+private:
+    struct Node
+    {
+        glm::vec3 boxMin, boxMax;
+        // leaf: first triangle and count; inner node: its two children, count 0
+        unsigned int first, count;
+        unsigned int second;
+    };
+
+    std::vector<Triangle> triangles;
+    // index in the constructor's soup of each sorted triangle
+    std::vector<unsigned int> ids;
+    std::vector<Node> nodes;
+
+    // builds the node for order[begin, end) and returns its index
+    unsigned int build(std::vector<unsigned int> &order, const std::vector<glm::vec3> &centroids, unsigned int begin, unsigned int end)
+    {
+        unsigned int index = (unsigned int)nodes.size();
+        nodes.push_back(Node());
+
+        Node node = {};
+        node.boxMin = glm::vec3(INFINITY);
+        node.boxMax = glm::vec3(-INFINITY);
+        glm::vec3 centroidMin(INFINITY), centroidMax(-INFINITY);
+        for (unsigned int i = begin; i < end; i++)
+        {
+            const Triangle &triangle = triangles[order[i]];
+            node.boxMin = glm::min(node.boxMin, glm::min(triangle.a, glm::min(triangle.b, triangle.c)));
+            node.boxMax = glm::max(node.boxMax, glm::max(triangle.a, glm::max(triangle.b, triangle.c)));
+            centroidMin = glm::min(centroidMin, centroids[order[i]]);
+            centroidMax = glm::max(centroidMax, centroids[order[i]]);
+        }
+
+        glm::vec3 extent = centroidMax - centroidMin;
+        if (end - begin <= (unsigned int)LEAF_SIZE || glm::max(extent.x, glm::max(extent.y, extent.z)) <= 0.0f)
+        {
+            node.first = begin;
+            node.count = end - begin;
+            nodes[index] = node;
+            return index;
+        }
+
+        int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+        unsigned int middle = begin + (end - begin) / 2;
+        std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+                         [&](unsigned int a, unsigned int b) { return centroids[a][axis] < centroids[b][axis]; });
+
+        // the left child follows its parent, the right one follows the left one's subtree
+        build(order, centroids, begin, middle);
+        node.second = build(order, centroids, middle, end);
+        node.first = index + 1;
+        node.count = 0;
+        nodes[index] = node;
+        return index;
+    }
+
+    static bool rayHitsBox(const glm::vec3 &origin, const glm::vec3 &inverse, float maxDistance, const glm::vec3 &boxMin, const glm::vec3 &boxMax)
+    {
+        float enter = 0.0f, exit = maxDistance;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float t0 = (boxMin[axis] - origin[axis]) * inverse[axis];
+            float t1 = (boxMax[axis] - origin[axis]) * inverse[axis];
+            // a ray parallel to the slab starting on one of its planes gives 0 * inf = NaN; it
+            // stays on that plane, inside the slab, so the slab does not limit it
+            if (std::isnan(t0) || std::isnan(t1))
+                continue;
+            enter = std::max(enter, std::min(t0, t1));
+            exit = std::min(exit, std::max(t0, t1));
+        }
+        return enter <= exit;
+    }
+
+    static bool rayHitsTriangle(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, const Triangle &triangle, Hit &hit)
+    {
+        glm::vec3 edge1 = triangle.b - triangle.a;
+        glm::vec3 edge2 = triangle.c - triangle.a;
+        glm::vec3 p = glm::cross(direction, edge2);
+        float determinant = glm::dot(edge1, p);
+        if (std::abs(determinant) < EPSILON)
+            return false;
+        float inverse = 1.0f / determinant;
+        glm::vec3 s = origin - triangle.a;
+        float u = glm::dot(s, p) * inverse;
+        if (u < 0.0f || u > 1.0f)
+            return false;
+        glm::vec3 q = glm::cross(s, edge1);
+        float v = glm::dot(direction, q) * inverse;
+        if (v < 0.0f || u + v > 1.0f)
+            return false;
+        float t = glm::dot(edge2, q) * inverse;
+        hit.distance = t;
+        hit.u = u;
+        hit.v = v;
+        return t > 0.0f && t < maxDistance;
+    }
+};
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef UNIFORM_BLOCKS_H
+#define UNIFORM_BLOCKS_H
+
+#include <glm/glm.hpp>
+
+#include "light.h"
+
+#include <cstddef>
+
+// Uniform and shader storage blocks shared by all scene shaders. The binding points are
+// hard-coded in the GLSL declarations (layout (std140, binding = N)), so no
+// glUniformBlockBinding / glShaderStorageBlockBinding call is needed.
+
+const unsigned int CAMERA_BLOCK_BINDING = 0;
+const unsigned int LIGHTING_BLOCK_BINDING = 1;
+// layout (std430, binding = 2) readonly buffer PointLights { PointLight pointLights[]; };
+const unsigned int POINT_LIGHTS_BINDING = 2;
+// layout (std430, binding = 3) readonly buffer SpotLights { SpotLight spotLights[]; };
+const unsigned int SPOTLIGHTS_BINDING = 3;
+// written by cluster_lights.comp, read by the lit fragment shaders (see light_clusters.h)
+// layout (std430, binding = 4) buffer ClusterLightCounts { uvec2 clusterLightCounts[]; };
+const unsigned int CLUSTER_LIGHT_COUNTS_BINDING = 4;
+// layout (std430, binding = 5) buffer ClusterLightIndices { uint clusterLightIndices[]; };
+const unsigned int CLUSTER_LIGHT_INDICES_BINDING = 5;
+// per-draw light lists built on the CPU (see object_lights.h)
+// layout (std430, binding = 6) readonly buffer ObjectLightIndices { uint objectLightIndices[]; };
+const unsigned int OBJECT_LIGHT_INDICES_BINDING = 6;
+// the sun's cascaded shadow maps (see shadow_cascades.h); uniform block binding points are
+// separate from the storage buffer ones above
+// layout (std140, binding = 2) uniform Shadows { ... };
+const unsigned int SHADOWS_BLOCK_BINDING = 2;
+// layout (binding = 8) uniform sampler2DArrayShadow shadowMap;
+// the units below belong to the meshes' textures (Mesh::MAX_TEXTURES)
+const unsigned int SHADOW_MAP_UNIT = 8;
+const int MAX_SHADOW_CASCADES = 4;
+// the car's headlights' shadow maps (see spot_shadows.h)
+// layout (std140, binding = 3) uniform SpotShadows { ... };
+const unsigned int SPOT_SHADOWS_BLOCK_BINDING = 3;
+// layout (binding = 9) uniform sampler2DArrayShadow spotShadowMap;
+const unsigned int SPOT_SHADOW_MAP_UNIT = 9;
+const int MAX_SHADOWED_SPOTLIGHTS = 2;
+// de_dust2's baked static lights (see lightmap.h)
+// layout (binding = 10) uniform sampler2D lightmap;
+const unsigned int LIGHTMAP_UNIT = 10;
+// the irradiance probes of the dynamic objects (see irradiance_probes.h)
+// layout (std430, binding = 7) readonly buffer IrradianceProbes { vec4 probeData[]; };
+const unsigned int IRRADIANCE_PROBES_BINDING = 7;
+
+// layout (std140, binding = 0) uniform Camera { mat4 view; mat4 projection; vec3 viewPos; };
+struct camera_block
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 viewPos; float pad0;
+};
+static_assert(offsetof(camera_block, viewPos) == 128, "Camera std140 layout");
+
+// layout (std140, binding = 1) uniform Lighting
+// {
+//     DirLight dirLight;
+//     vec3 fogColor;
+//     float fogIntensity;
+//     int pointLightCount;
+//     int spotLightCount;
+//     vec2 screenSize;
+//     ivec4 clusterGrid;
+//     float clusterScale;
+//     float clusterNear;
+//     vec4 probeGridOrigin;
+//     ivec4 probeGridSize;
+// };
+// The point lights and spotlights themselves live in the storage buffers of LightRegistry.
+// Shading model, fog and clustering are compile-time variants (shader_features.h), not fields.
+struct lighting_block
+{
+    dir_light_std140 dirLight;
+    glm::vec3 fogColor;
+    float fogIntensity;
+    int pointLightCount;
+    int spotLightCount;
+    glm::vec2 screenSize;
+    glm::ivec4 clusterGrid; // x, y, z, lights per cluster
+    float clusterScale;
+    float clusterNear;
+    float pad0[2];
+    glm::vec4 probeGridOrigin; // xyz: the first probe, w: the spacing
+    glm::ivec4 probeGridSize;  // probes along x, y, z; w 0: no probes, flat ambient
+};
+static_assert(offsetof(lighting_block, fogColor) == 64, "Lighting std140 layout");
+static_assert(offsetof(lighting_block, pointLightCount) == 80, "Lighting std140 layout");
+static_assert(offsetof(lighting_block, screenSize) == 88, "Lighting std140 layout");
+static_assert(offsetof(lighting_block, clusterGrid) == 96, "Lighting std140 layout");
+static_assert(offsetof(lighting_block, clusterNear) == 116, "Lighting std140 layout");
+static_assert(offsetof(lighting_block, probeGridOrigin) == 128, "Lighting std140 layout");
+static_assert(offsetof(lighting_block, probeGridSize) == 144, "Lighting std140 layout");
+
+// layout (std140, binding = 2) uniform Shadows
+// {
+//     mat4 cascadeMatrices[4];
+//     vec4 cascadeSplits;
+//     vec4 cascadeTexelSizes;
+//     int cascadeCount;
+//     int pcfRadius;
+// };
+struct shadows_block
+{
+    glm::mat4 cascadeMatrices[MAX_SHADOW_CASCADES]; // world to shadow map texture space
+    glm::vec4 cascadeSplits;                        // view distance where each cascade ends
+    glm::vec4 cascadeTexelSizes;                    // world size of one shadow map texel
+    int cascadeCount;                               // 0: no shadows
+    int pcfRadius;
+    float pad0[2];
+};
+static_assert(offsetof(shadows_block, cascadeSplits) == 256, "Shadows std140 layout");
+static_assert(offsetof(shadows_block, cascadeCount) == 288, "Shadows std140 layout");
+
+// layout (std140, binding = 3) uniform SpotShadows
+// {
+//     mat4 spotShadowMatrices[2];
+//     float spotShadowTexelScale;
+//     int spotShadowCount;
+// };
+struct spot_shadows_block
+{
+    glm::mat4 spotShadowMatrices[MAX_SHADOWED_SPOTLIGHTS]; // world to shadow map texture space, before the divide by w
+    float spotShadowTexelScale;                            // world size of one texel per unit of distance from the light
+    int spotShadowCount;                                   // 0: no shadows
+    float pad0[2];
+};
+static_assert(offsetof(spot_shadows_block, spotShadowTexelScale) == 128, "SpotShadows std140 layout");
+static_assert(sizeof(spot_shadows_block) == 144, "SpotShadows std140 size");
+
+#endif
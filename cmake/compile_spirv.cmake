@@ -0,0 +1,126 @@
+# Compiles one shader stage to SPIR-V for OpenGL with glslangValidator, once per combination of
+# the features that select code in it with #ifdef. #include lines are expanded as Shader does and
+# the defines go right after #version, so a module matches the GLSL Shader would have compiled.
+# Features the stage declares as specialization constants (features.glsl) are not compiled in.
+# Modules are written as OUTPUT_DIR/<stage file>[.FEATURE...].spv, the names Shader looks for.
+# usage: cmake -DGLSLANG_VALIDATOR=path -DSTAGE=file -DFEATURES=A|B -DOUTPUT_DIR=dir -P compile_spirv.cmake
+
+# replaces every #include "file" line of path with the file, once per stage, between #line directives
+function(expand_includes path source_number out_var)
+    file(READ "${path}" content)
+    get_filename_component(directory "${path}" DIRECTORY)
+    set(result "")
+    set(line_number 0)
+    while(NOT content STREQUAL "")
+        string(FIND "${content}" "\n" line_end)
+        if(line_end EQUAL -1)
+            set(line "${content}")
+            set(content "")
+        else()
+            string(SUBSTRING "${content}" 0 ${line_end} line)
+            math(EXPR line_end "${line_end} + 1")
+            string(SUBSTRING "${content}" ${line_end} -1 content)
+        endif()
+        math(EXPR line_number "${line_number} + 1")
+        if(NOT line MATCHES "^[ \t]*#include")
+            string(APPEND result "${line}\n")
+            continue()
+        endif()
+        if(NOT line MATCHES "^[ \t]*#include[^\"]*\"([^\"]*)\"")
+            message(FATAL_ERROR "${path}:${line_number}: invalid #include")
+        endif()
+        set(include_path "${directory}/${CMAKE_MATCH_1}")
+        get_property(included GLOBAL PROPERTY INCLUDED_FILES)
+        list(FIND included "${include_path}" index)
+        if(index EQUAL -1)
+            list(LENGTH included include_number)
+            set_property(GLOBAL APPEND PROPERTY INCLUDED_FILES "${include_path}")
+            expand_includes("${include_path}" ${include_number} expanded)
+            string(APPEND result "#line 1 ${include_number}\n${expanded}")
+        endif()
+        math(EXPR next_line "${line_number} + 1")
+        string(APPEND result "#line ${next_line} ${source_number}\n")
+    endwhile()
+    set(${out_var} "${result}" PARENT_SCOPE)
+endfunction()
+
+get_filename_component(name "${STAGE}" NAME)
+get_filename_component(extension "${STAGE}" LAST_EXT)
+set(STAGE_vs vert)
+set(STAGE_fs frag)
+set(STAGE_gs geom)
+set(STAGE_tcs tesc)
+set(STAGE_tes tese)
+set(STAGE_comp comp)
+string(SUBSTRING "${extension}" 1 -1 extension)
+set(stage_type "${STAGE_${extension}}")
+if(NOT stage_type)
+    message(FATAL_ERROR "${name}: unknown shader stage")
+endif()
+
+set_property(GLOBAL PROPERTY INCLUDED_FILES "${STAGE}")
+expand_includes("${STAGE}" 0 source)
+
+# the features compiled in: mentioned in the stage and not a specialization constant
+string(REGEX MATCHALL "constant_id[ \t]*=[ \t]*[0-9]+[ \t]*\\)[ \t]*const[ \t]+bool[ \t]+[A-Za-z0-9_]+_ENABLED" declarations "${source}")
+set(constants "")
+foreach(declaration ${declarations})
+    string(REGEX REPLACE ".*bool[ \t]+([A-Za-z0-9_]+)_ENABLED$" "\\1" constant "${declaration}")
+    list(APPEND constants ${constant})
+endforeach()
+string(REPLACE "|" ";" FEATURES "${FEATURES}")
+set(variant_features "")
+foreach(feature ${FEATURES})
+    list(FIND constants ${feature} constant_index)
+    if(constant_index EQUAL -1 AND source MATCHES "(^|[^A-Za-z0-9_])${feature}([^A-Za-z0-9_]|$)")
+        list(APPEND variant_features ${feature})
+    endif()
+endforeach()
+
+# the #define lines go after #version, followed by the #line that restores its numbering
+string(FIND "${source}" "#version" version_start)
+string(SUBSTRING "${source}" ${version_start} -1 from_version)
+string(FIND "${from_version}" "\n" version_end)
+math(EXPR version_end "${version_start} + ${version_end} + 1")
+string(SUBSTRING "${source}" 0 ${version_end} head)
+string(SUBSTRING "${source}" ${version_end} -1 tail)
+string(REGEX MATCHALL "\n" head_lines "${head}")
+list(LENGTH head_lines next_line)
+math(EXPR next_line "${next_line} + 1")
+
+file(MAKE_DIRECTORY "${OUTPUT_DIR}")
+list(LENGTH variant_features feature_count)
+math(EXPR combinations "1 << ${feature_count}")
+set(mask 0)
+while(mask LESS combinations)
+    set(suffix "")
+    set(defines "")
+    set(bit 0)
+    foreach(feature ${variant_features})
+        math(EXPR selected "(${mask} >> ${bit}) & 1")
+        if(selected)
+            string(APPEND suffix ".${feature}")
+            string(APPEND defines "#define ${feature}\n")
+        endif()
+        math(EXPR bit "${bit} + 1")
+    endforeach()
+    set(variant_source "${source}")
+    if(NOT defines STREQUAL "")
+        set(variant_source "${head}${defines}#line ${next_line}\n${tail}")
+    endif()
+    set(module "${OUTPUT_DIR}/${name}${suffix}.spv")
+    # kept next to the module: compiler messages refer to its lines
+    set(expanded "${OUTPUT_DIR}/${name}${suffix}.glsl")
+    file(WRITE "${expanded}" "${variant_source}")
+    execute_process(
+        COMMAND "${GLSLANG_VALIDATOR}" -G -S ${stage_type} -o "${module}" "${expanded}"
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE output)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${name}${suffix}:\n${output}")
+    endif()
+    math(EXPR mask "${mask} + 1")
+endwhile()
+
+file(WRITE "${OUTPUT_DIR}/${name}.stamp" "")
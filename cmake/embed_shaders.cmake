@@ -0,0 +1,33 @@
+# Writes OUTPUT, a header with every file of SHADER_FILES (separated by "|") as a constexpr string,
+# keyed by its path relative to SOURCE_DIR; read by Shader when built with EMBED_SHADERS.
+# usage: cmake -DSOURCE_DIR=dir -DSHADER_FILES=a.vs|b.fs -DOUTPUT=embedded_shaders.h -P embed_shaders.cmake
+
+# raw string pieces stay below MSVC's limit of 16380 bytes per literal
+set(CHUNK_SIZE 8000)
+
+string(REPLACE "|" ";" SHADER_FILES "${SHADER_FILES}")
+list(SORT SHADER_FILES)
+
+set(header "// generated by cmake/embed_shaders.cmake from the shaders in OpenGL/, do not edit\n")
+string(APPEND header "#ifndef EMBEDDED_SHADERS_H\n#define EMBEDDED_SHADERS_H\n\n#include <string_view>\n\n")
+string(APPEND header "struct EmbeddedShader\n{\n    std::string_view path;\n    std::string_view source;\n};\n\n")
+string(APPEND header "inline constexpr EmbeddedShader EMBEDDED_SHADERS[] = {\n")
+foreach(file ${SHADER_FILES})
+    file(RELATIVE_PATH name "${SOURCE_DIR}" "${file}")
+    file(READ "${file}" source)
+    string(LENGTH "${source}" length)
+    string(APPEND header "    { \"${name}\",\n")
+    set(offset 0)
+    while(offset LESS length)
+        string(SUBSTRING "${source}" ${offset} ${CHUNK_SIZE} chunk)
+        string(APPEND header "      R\"glsl(${chunk})glsl\"\n")
+        math(EXPR offset "${offset} + ${CHUNK_SIZE}")
+    endwhile()
+    if(length EQUAL 0)
+        string(APPEND header "      \"\"\n")
+    endif()
+    string(APPEND header "    },\n")
+endforeach()
+string(APPEND header "};\n\n#endif\n")
+
+file(WRITE "${OUTPUT}" "${header}")
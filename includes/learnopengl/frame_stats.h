@@ -0,0 +1,116 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <algorithm>
+#include <vector>
+
+// Fixed-size history of per-frame CPU and GPU times for the Debug window.
+//
+// A smoothed FPS number hides single slow frames, so the history keeps every frame of the last
+// CAPACITY frames and reports percentiles and the worst frame, plus a count of hitches:
+// frames whose CPU or GPU time went over the frame budget.
+class FrameStats
+{
+public:
+    static const int CAPACITY = 512;
+
+    // a frame slower than this counts as a hitch
+    float budgetMs = 1000.0f / 60.0f;
+    // hitches since the last resetHitches()
+    unsigned int hitches = 0;
+
+    struct Summary
+    {
+        float p50 = 0.0f;
+        float p95 = 0.0f;
+        float p99 = 0.0f;
+        float max = 0.0f;
+    };
+
+    void push(float cpuMs, float gpuMs)
+    {
+        cpu[next] = cpuMs;
+        gpu[next] = gpuMs;
+        next = (next + 1) % CAPACITY;
+        if (count < CAPACITY)
+            count++;
+        if (cpuMs > budgetMs || gpuMs > budgetMs)
+            hitches++;
+    }
+
+    void resetHitches()
+    {
+        hitches = 0;
+    }
+
+    int size() const
+    {
+        return count;
+    }
+
+    // the ring buffers and the index of the oldest sample, as ImGui::PlotLines takes them
+    const float *cpuValues() const
+    {
+        return cpu;
+    }
+
+    const float *gpuValues() const
+    {
+        return gpu;
+    }
+
+    int offset() const
+    {
+        return count < CAPACITY ? 0 : next;
+    }
+
+    Summary cpuSummary() const
+    {
+        return summarize(cpu);
+    }
+
+    Summary gpuSummary() const
+    {
+        return summarize(gpu);
+    }
+
+    // fills bins with how many frames fall into each of binCount equal ranges of [0, rangeMs);
+    // slower frames go into the last bin
+    void histogram(const float *values, float *bins, int binCount, float rangeMs) const
+    {
+        std::fill(bins, bins + binCount, 0.0f);
+        for (int i = 0; i < count; i++)
+        {
+            int bin = (int)(values[i] / rangeMs * binCount);
+            bins[std::min(std::max(bin, 0), binCount - 1)] += 1.0f;
+        }
+    }
+
+private:
+    float cpu[CAPACITY] = {};
+    float gpu[CAPACITY] = {};
+    int next = 0;
+    int count = 0;
+
+    // nearest-rank percentiles
+    Summary summarize(const float *values) const
+    {
+        Summary summary;
+        if (count == 0)
+            return summary;
+        std::vector<float> sorted(values, values + count);
+        std::sort(sorted.begin(), sorted.end());
+        auto rank = [&](float percent)
+        {
+            int index = (int)(percent / 100.0f * count + 0.999f) - 1;
+            return sorted[std::min(std::max(index, 0), count - 1)];
+        };
+        summary.p50 = rank(50.0f);
+        summary.p95 = rank(95.0f);
+        summary.p99 = rank(99.0f);
+        summary.max = sorted.back();
+        return summary;
+    }
+};
+
+#endif
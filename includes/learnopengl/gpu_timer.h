@@ -0,0 +1,212 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+
+// Per-pass GPU timing with GL_TIME_ELAPSED queries.
+//
+// Every pass owns one query per frame slot and the slots form a ring FRAMES_IN_FLIGHT deep:
+// a result is only read once GL_QUERY_RESULT_AVAILABLE says so, by which time the GPU has
+// long finished that frame, so reading never stalls the pipeline. A result that is still not
+// available when its slot comes round again is dropped rather than waited for.
+//
+// Time-elapsed queries cannot nest, so passes must not overlap. Needs a current GL context.
+class GpuTimer
+{
+public:
+    static const int FRAMES_IN_FLIGHT = 4;
+    // number of frames the rolling average covers
+    static const int HISTORY = 64;
+
+    struct Pass
+    {
+        std::string name;
+        float lastMs = 0.0f;
+        float history[HISTORY] = {};
+        int historyCount = 0;
+        int historyNext = 0;
+        // every result read since the last resetTotals()
+        double totalMs = 0.0;
+        unsigned int totalSamples = 0;
+
+        float averageMs() const
+        {
+            if (historyCount == 0)
+                return 0.0f;
+            float sum = 0.0f;
+            for (int i = 0; i < historyCount; i++)
+                sum += history[i];
+            return sum / historyCount;
+        }
+
+        double meanMs() const
+        {
+            return totalSamples ? totalMs / totalSamples : 0.0;
+        }
+    };
+
+    std::vector<Pass> passes;
+    // results overwritten before they became available
+    unsigned int dropped = 0;
+    // GPU time of all passes of the most recent frame whose results are complete
+    float lastFrameMs = 0.0f;
+
+    GpuTimer() = default;
+
+    // passes are identified by their index in this list
+    explicit GpuTimer(const std::vector<std::string> &names)
+    {
+        passes.resize(names.size());
+        for (size_t i = 0; i < names.size(); i++)
+            passes[i].name = names[i];
+        queries.resize(names.size() * FRAMES_IN_FLIGHT);
+        pending.resize(queries.size(), false);
+        glGenQueries((GLsizei)queries.size(), queries.data());
+    }
+
+    ~GpuTimer()
+    {
+        if (!queries.empty())
+            glDeleteQueries((GLsizei)queries.size(), queries.data());
+    }
+
+    GpuTimer(const GpuTimer &) = delete;
+    GpuTimer &operator=(const GpuTimer &) = delete;
+
+    // call once at the start of every frame: collects the results that are ready and moves to the next slot
+    void beginFrame()
+    {
+        collect(false);
+        slot = (slot + 1) % FRAMES_IN_FLIGHT;
+        slotMs[slot] = 0.0f;
+        for (size_t pass = 0; pass < passes.size(); pass++)
+        {
+            if (pending[index(slot, pass)])
+            {
+                pending[index(slot, pass)] = false;
+                dropped++;
+            }
+        }
+    }
+
+    void begin(int pass)
+    {
+        glBeginQuery(GL_TIME_ELAPSED, queries[index(slot, pass)]);
+    }
+
+    void end(int pass)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        pending[index(slot, pass)] = true;
+    }
+
+    // blocks until every issued query has its result, e.g. before reporting at the end of a run
+    void flush()
+    {
+        collect(true);
+    }
+
+    void resetTotals()
+    {
+        for (Pass &pass : passes)
+        {
+            pass.totalMs = 0.0;
+            pass.totalSamples = 0;
+        }
+        dropped = 0;
+    }
+
+    // sum of the rolling averages of all passes
+    float averageTotalMs() const
+    {
+        float sum = 0.0f;
+        for (const Pass &pass : passes)
+            sum += pass.averageMs();
+        return sum;
+    }
+
+    // times one pass for the lifetime of the scope
+    class Scope
+    {
+    public:
+        Scope(GpuTimer &timer, int pass) : timer(timer), pass(pass)
+        {
+            timer.begin(pass);
+        }
+
+        ~Scope()
+        {
+            timer.end(pass);
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        GpuTimer &timer;
+        int pass;
+    };
+
+private:
+    std::vector<GLuint> queries;
+    std::vector<bool> pending;
+    int slot = 0;
+    float slotMs[FRAMES_IN_FLIGHT] = {};
+
+    size_t index(int frameSlot, size_t pass) const
+    {
+        return (size_t)frameSlot * passes.size() + pass;
+    }
+
+    void collect(bool wait)
+    {
+        // oldest slot first so the history stays in frame order
+        for (int age = FRAMES_IN_FLIGHT - 1; age >= 0; age--)
+        {
+            int frameSlot = (slot - age + FRAMES_IN_FLIGHT) % FRAMES_IN_FLIGHT;
+            bool read = false;
+            bool complete = true;
+            for (size_t pass = 0; pass < passes.size(); pass++)
+            {
+                size_t i = index(frameSlot, pass);
+                if (!pending[i])
+                    continue;
+                if (!wait)
+                {
+                    GLint available = 0;
+                    glGetQueryObjectiv(queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+                    if (!available)
+                    {
+                        complete = false;
+                        continue;
+                    }
+                }
+                GLuint64 ns = 0;
+                glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &ns);
+                pending[i] = false;
+                read = true;
+                float ms = ns / 1.0e6f;
+                record(passes[pass], ms);
+                slotMs[frameSlot] += ms;
+            }
+            if (read && complete)
+                lastFrameMs = slotMs[frameSlot];
+        }
+    }
+
+    static void record(Pass &pass, float ms)
+    {
+        pass.lastMs = ms;
+        pass.history[pass.historyNext] = ms;
+        pass.historyNext = (pass.historyNext + 1) % HISTORY;
+        if (pass.historyCount < HISTORY)
+            pass.historyCount++;
+        pass.totalMs += ms;
+        pass.totalSamples++;
+    }
+};
+
+#endif
@@ -7,7 +7,9 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <learnopengl/shader.h>
+#include <learnopengl/profiler.h>
 
+#include <iostream>
 #include <string>
 #include <vector>
 using namespace std;
@@ -37,73 +39,197 @@ struct Texture
     unsigned int id;
     string type;
     string path;
+    // image size, filled in when the texture was loaded from a file
+    int width = 0;
+    int height = 0;
+    int components = 0;
+
+    // estimated GPU memory with the full mip chain (+1/3); drivers pad 3-channel textures to 4
+    size_t gpuBytes() const
+    {
+        size_t texelBytes = components == 3 ? 4 : (size_t)components;
+        return (size_t)width * height * texelBytes * 4 / 3;
+    }
+};
+
+// bytes resident in RAM and estimated bytes on the GPU
+struct MemoryUsage
+{
+    size_t cpuBytes = 0;
+    size_t gpuBytes = 0;
+
+    MemoryUsage &operator+=(const MemoryUsage &other)
+    {
+        cpuBytes += other.cpuBytes;
+        gpuBytes += other.gpuBytes;
+        return *this;
+    }
 };
 
 class Mesh
 {
 public:
+    // textures are bound to units 1 .. MAX_TEXTURES; the units above are left to the caller
+    // (the scene keeps its shadow maps and lightmap there)
+    static const unsigned int MAX_TEXTURES = 7;
+
     // mesh Data
     vector<Vertex>       vertices;
     vector<unsigned int> indices;
     vector<Texture>      textures;
     unsigned int VAO;
+    // attribute 0 only, over the same buffers: for depth-only passes that need no other attribute
+    unsigned int positionsVAO;
+    // sizes of the uploaded buffers, still valid after releaseGeometry()
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    // axis-aligned bounds of the vertex positions in model space, kept after releaseGeometry()
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    // number of lightmap coordinates uploaded by setLightmapCoords(), 0 without
+    size_t lightmapCoordCount = 0;
+    // vertices setLightmapCoords() appended to the vertex buffer, each a copy of a loaded one
+    size_t lightmapCopyCount = 0;
 
     // constructor
     Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
     {
-        this->vertices = vertices;
-        this->indices = indices;
-        this->textures = textures;
+        this->vertices = std::move(vertices);
+        this->indices = std::move(indices);
+        this->textures = std::move(textures);
+        if (this->textures.size() > MAX_TEXTURES)
+        {
+            std::cout << "ERROR::MESH::TOO_MANY_TEXTURES: " << this->textures.size() << ", only the first "
+                      << MAX_TEXTURES << " are used" << std::endl;
+            this->textures.resize(MAX_TEXTURES);
+        }
 
         // now that we have all the required data, set the vertex buffers and its attribute pointers.
         setupMesh();
+        setupSamplerNames();
     }
 
     // render the mesh
     void Draw(Shader &shader)
     {
+        PROFILE_ZONE("Mesh::Draw");
         // bind appropriate textures
-        unsigned int diffuseNr = 1;
-        unsigned int specularNr = 1;
-        unsigned int normalNr = 1;
-        unsigned int heightNr = 1;
-
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, 0);
 
         for (unsigned int i = 0; i < textures.size(); i++)
         {
             glActiveTexture(GL_TEXTURE0 + i + 1); // active proper texture unit before binding
-            // retrieve texture number (the N in diffuse_textureN)
-            string number;
-            string name = textures[i].type;
-            if (name == "texture_diffuse")
-                number = std::to_string(diffuseNr++);
-            else if (name == "texture_specular")
-                number = std::to_string(specularNr++); // transfer unsigned int to string
-            else if (name == "texture_normal")
-                number = std::to_string(normalNr++); // transfer unsigned int to string
-            else if (name == "texture_height")
-                number = std::to_string(heightNr++); // transfer unsigned int to string
-
             // now set the sampler to the correct texture unit
-            glUniform1i(glGetUniformLocation(shader.ID, (name + number).c_str()), i + 1);
+            shader.setInt(samplerNames[i], i + 1);
             // and finally bind the texture
             glBindTexture(GL_TEXTURE_2D, textures[i].id);
         }
 
         // draw mesh
         glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
+        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indexCount), GL_UNSIGNED_INT, 0);
         glBindVertexArray(0);
 
-        diffuseNr = 1;
-        specularNr = 1;
-        normalNr = 1;
-        heightNr = 1;
         for (unsigned int i = 0; i < textures.size(); i++)
         {
             glActiveTexture(GL_TEXTURE0 + i + 1); // active proper texture unit before binding
+            // back to the empty unit 0: samplers keep their unit from draw to draw, so a mesh
+            // without this texture would otherwise read another's, bound to the same unit
+            shader.setInt(samplerNames[i], 0);
+            // and finally bind the texture
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        // always good practice to set everything back to defaults once configured.
+        glActiveTexture(GL_TEXTURE0);
+
+    }
+
+    // render only the positions, no textures bound; for depth-only passes
+    void DrawPositions()
+    {
+        glBindVertexArray(positionsVAO);
+        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indexCount), GL_UNSIGNED_INT, 0);
+        glBindVertexArray(0);
+    }
+
+    // adds a second UV set, e.g. the charts of a baked lightmap, as attribute 7 from its own buffer;
+    // one per vertex. A vertex on the seam of two charts needs two coordinates: copies lists, for
+    // the coordinates past the loaded vertices, the loaded vertex each one copies, and
+    // newIndices, if not empty, replaces the index buffer to draw with them. Only the GPU
+    // buffers change; the CPU copy (keepGeometry) keeps the geometry as loaded.
+    void setLightmapCoords(const vector<glm::vec2> &coords, const vector<unsigned int> &copies = {},
+                           const vector<unsigned int> &newIndices = {})
+    {
+        if (!copies.empty() || lightmapCopyCount > 0)
+        {
+            size_t loaded = vertexCount - lightmapCopyCount;
+            unsigned int grown;
+            glGenBuffers(1, &grown);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+            glBufferData(GL_COPY_WRITE_BUFFER, (loaded + copies.size()) * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
+            glBindBuffer(GL_COPY_READ_BUFFER, VBO);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, loaded * sizeof(Vertex));
+            for (size_t i = 0; i < copies.size(); i++)
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, copies[i] * sizeof(Vertex),
+                                    (loaded + i) * sizeof(Vertex), sizeof(Vertex));
+            glDeleteBuffers(1, &VBO);
+            VBO = grown;
+            vertexCount = loaded + copies.size();
+            lightmapCopyCount = copies.size();
+            setupAttributes();
+        }
+        if (!newIndices.empty())
+        {
+            indexCount = newIndices.size();
+            glBindVertexArray(VAO);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, newIndices.size() * sizeof(unsigned int), newIndices.data(), GL_STATIC_DRAW);
+            glBindVertexArray(0);
+        }
+
+        if (lightmapVBO == 0)
+            glGenBuffers(1, &lightmapVBO);
+        lightmapCoordCount = coords.size();
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, lightmapVBO);
+        glBufferData(GL_ARRAY_BUFFER, coords.size() * sizeof(glm::vec2), coords.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(7);
+        glVertexAttribPointer(7, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void *)0);
+        glBindVertexArray(0);
+    }
+
+    // frees the CPU copy of the vertices and indices; the GPU buffers keep drawing
+    void releaseGeometry()
+    {
+        vector<Vertex>().swap(vertices);
+        vector<unsigned int>().swap(indices);
+    }
+
+    // CPU: the vertex and index arrays; GPU: the vertex and index buffers (textures are counted by their Model)
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage usage;
+        usage.cpuBytes = vertices.capacity() * sizeof(Vertex) + indices.capacity() * sizeof(unsigned int);
+        usage.gpuBytes = vertexCount * sizeof(Vertex) + indexCount * sizeof(unsigned int) + lightmapCoordCount * sizeof(glm::vec2);
+        return usage;
+    }
+
+private:
+    // render data 
+    unsigned int VBO, EBO;
+    unsigned int lightmapVBO = 0;
+    // sampler uniform of each texture ("texture_diffuse1", ...), named once instead of on every draw
+    vector<string> samplerNames;
+
+    // follows the sampler naming convention: each texture type is numbered from 1
+    void setupSamplerNames()
+    {
+        unsigned int diffuseNr = 1;
+        unsigned int specularNr = 1;
+        unsigned int normalNr = 1;
+        unsigned int heightNr = 1;
+        for (unsigned int i = 0; i < textures.size(); i++)
+        {
             // retrieve texture number (the N in diffuse_textureN)
             string number;
             string name = textures[i].type;
@@ -115,30 +241,31 @@ public:
                 number = std::to_string(normalNr++); // transfer unsigned int to string
             else if (name == "texture_height")
                 number = std::to_string(heightNr++); // transfer unsigned int to string
-
-            // now set the sampler to the correct texture unit
-            glUniform1i(glGetUniformLocation(shader.ID, (name + number).c_str()), 0);
-            // and finally bind the texture
-            glBindTexture(GL_TEXTURE_2D, 0);
+            samplerNames.push_back(name + number);
         }
-        // always good practice to set everything back to defaults once configured.
-        glActiveTexture(GL_TEXTURE0);
-
     }
 
-private:
-    // render data 
-    unsigned int VBO, EBO;
-
     // initializes all the buffer objects/arrays
     void setupMesh()
     {
+        vertexCount = vertices.size();
+        indexCount = indices.size();
+        if (!vertices.empty())
+        {
+            boundsMin = boundsMax = vertices[0].Position;
+            for (const Vertex &vertex : vertices)
+            {
+                boundsMin = glm::min(boundsMin, vertex.Position);
+                boundsMax = glm::max(boundsMax, vertex.Position);
+            }
+        }
+
         // create buffers/arrays
         glGenVertexArrays(1, &VAO);
+        glGenVertexArrays(1, &positionsVAO);
         glGenBuffers(1, &VBO);
         glGenBuffers(1, &EBO);
 
-        glBindVertexArray(VAO);
         // load data into vertex buffers
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
         // A great thing about structs is that their memory layout is sequential for all its items.
@@ -146,9 +273,21 @@ private:
         // again translates to 3/2 floats which translates to a byte array.
         glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
 
+        glBindVertexArray(VAO);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        glBindVertexArray(positionsVAO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBindVertexArray(0);
 
+        setupAttributes();
+    }
+
+    // points both vertex arrays at VBO
+    void setupAttributes()
+    {
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
         // set the vertex attribute pointers
         // vertex Positions
         glEnableVertexAttribArray(0);
@@ -172,6 +311,10 @@ private:
         // weights
         glEnableVertexAttribArray(6);
         glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, m_Weights));
+
+        glBindVertexArray(positionsVAO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
         glBindVertexArray(0);
     }
 };
@@ -0,0 +1,390 @@
+#ifndef MOCK_GL_H
+#define MOCK_GL_H
+
+#include <glad/glad.h>
+
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+
+// No-op OpenGL implementation for running the renderer without a driver or display.
+//
+// Pass mockgl::getProcAddress to gladLoadGLLoader instead of the window system's loader and
+// every GL entry point the project uses does nothing except hand out object names, report
+// successful compiles, links and complete framebuffers, and count the calls that make up the
+// CPU-side submission cost (see mockgl::Counters). Entry points not implemented here stay
+// NULL, so using a new one crashes at the call and shows what to add.
+namespace mockgl
+{
+    // calls since the last reset(); bench resets them every frame
+    struct Counters
+    {
+        unsigned long drawCalls = 0;
+        unsigned long uniformUploads = 0;
+        unsigned long uniformLookups = 0;   // glGetUniformLocation
+        unsigned long textureBinds = 0;
+        unsigned long bufferUploads = 0;    // glBufferData / glBufferSubData
+        unsigned long bufferUploadBytes = 0;
+        unsigned long textureUploads = 0;   // glTexImage2D / glTexImage3D
+        unsigned long programBinds = 0;
+
+        void reset()
+        {
+            *this = Counters();
+        }
+    };
+
+    inline Counters &counters()
+    {
+        static Counters instance;
+        return instance;
+    }
+
+    struct State
+    {
+        GLuint nextName = 1;
+        // locations are handed out per program in order of first lookup
+        std::map<std::pair<GLuint, std::string>, GLint> uniformLocations;
+        std::map<GLuint, GLint> nextLocation;
+    };
+
+    inline State &state()
+    {
+        static State instance;
+        return instance;
+    }
+
+    inline void genNames(GLsizei n, GLuint *names)
+    {
+        for (GLsizei i = 0; i < n; i++)
+            names[i] = state().nextName++;
+    }
+
+    // state and queries
+    // -----------------
+    inline const GLubyte *APIENTRY GetString(GLenum name)
+    {
+        switch (name)
+        {
+        case GL_VENDOR: return (const GLubyte *)"mockgl";
+        case GL_RENDERER: return (const GLubyte *)"Mock GL (no-op)";
+        case GL_VERSION: return (const GLubyte *)"4.6 Mock GL";
+        case GL_SHADING_LANGUAGE_VERSION: return (const GLubyte *)"4.60";
+        default: return (const GLubyte *)"";
+        }
+    }
+
+    // glad refuses a context with no extensions at all, so advertise a single made-up one
+    inline const GLubyte *APIENTRY GetStringi(GLenum, GLuint)
+    {
+        return (const GLubyte *)"GL_MOCK_no_op";
+    }
+
+    inline void APIENTRY GetIntegerv(GLenum pname, GLint *data)
+    {
+        *data = pname == GL_NUM_EXTENSIONS ? 1 : 0;
+    }
+
+    inline GLenum APIENTRY GetError()
+    {
+        return GL_NO_ERROR;
+    }
+
+    inline void APIENTRY Enable(GLenum) {}
+    inline void APIENTRY Disable(GLenum) {}
+    inline void APIENTRY BlendFunc(GLenum, GLenum) {}
+    inline void APIENTRY CullFace(GLenum) {}
+    inline void APIENTRY DepthFunc(GLenum) {}
+    inline void APIENTRY DepthMask(GLboolean) {}
+    inline void APIENTRY Viewport(GLint, GLint, GLsizei, GLsizei) {}
+    inline void APIENTRY ClearColor(GLfloat, GLfloat, GLfloat, GLfloat) {}
+    inline void APIENTRY Clear(GLbitfield) {}
+    inline void APIENTRY Finish() {}
+    inline void APIENTRY Flush() {}
+    inline void APIENTRY PatchParameteri(GLenum, GLint) {}
+    inline void APIENTRY PolygonOffset(GLfloat, GLfloat) {}
+
+    // shaders and programs
+    // --------------------
+    inline GLuint APIENTRY CreateShader(GLenum)
+    {
+        return state().nextName++;
+    }
+
+    inline GLuint APIENTRY CreateProgram()
+    {
+        return state().nextName++;
+    }
+
+    inline void APIENTRY ShaderSource(GLuint, GLsizei, const GLchar *const *, const GLint *) {}
+    inline void APIENTRY CompileShader(GLuint) {}
+    inline void APIENTRY AttachShader(GLuint, GLuint) {}
+    inline void APIENTRY LinkProgram(GLuint) {}
+    inline void APIENTRY DeleteShader(GLuint) {}
+    inline void APIENTRY DeleteProgram(GLuint) {}
+
+    inline void APIENTRY GetShaderiv(GLuint, GLenum pname, GLint *params)
+    {
+        *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+    }
+
+    inline void APIENTRY GetProgramiv(GLuint, GLenum pname, GLint *params)
+    {
+        *params = pname == GL_LINK_STATUS ? GL_TRUE : 0;
+    }
+
+    inline void APIENTRY GetInfoLog(GLuint, GLsizei bufSize, GLsizei *length, GLchar *infoLog)
+    {
+        if (length)
+            *length = 0;
+        if (infoLog && bufSize > 0)
+            infoLog[0] = '\0';
+    }
+
+    inline void APIENTRY UseProgram(GLuint)
+    {
+        counters().programBinds++;
+    }
+
+    inline GLint APIENTRY GetUniformLocation(GLuint program, const GLchar *name)
+    {
+        counters().uniformLookups++;
+        State &s = state();
+        auto key = std::make_pair(program, std::string(name));
+        auto found = s.uniformLocations.find(key);
+        if (found != s.uniformLocations.end())
+            return found->second;
+        GLint location = s.nextLocation[program]++;
+        s.uniformLocations[key] = location;
+        return location;
+    }
+
+    // uniforms
+    // --------
+    inline void APIENTRY Uniform1i(GLint, GLint) { counters().uniformUploads++; }
+    inline void APIENTRY Uniform1f(GLint, GLfloat) { counters().uniformUploads++; }
+    inline void APIENTRY Uniform2f(GLint, GLfloat, GLfloat) { counters().uniformUploads++; }
+    inline void APIENTRY Uniform3f(GLint, GLfloat, GLfloat, GLfloat) { counters().uniformUploads++; }
+    inline void APIENTRY Uniform4f(GLint, GLfloat, GLfloat, GLfloat, GLfloat) { counters().uniformUploads++; }
+    inline void APIENTRY Uniformfv(GLint, GLsizei, const GLfloat *) { counters().uniformUploads++; }
+    inline void APIENTRY Uniformiv(GLint, GLsizei, const GLint *) { counters().uniformUploads++; }
+    inline void APIENTRY UniformMatrixfv(GLint, GLsizei, GLboolean, const GLfloat *) { counters().uniformUploads++; }
+
+    // buffers and vertex arrays
+    // -------------------------
+    inline void APIENTRY GenNames(GLsizei n, GLuint *names)
+    {
+        genNames(n, names);
+    }
+
+    inline void APIENTRY DeleteNames(GLsizei, const GLuint *) {}
+    inline void APIENTRY BindBuffer(GLenum, GLuint) {}
+    inline void APIENTRY BindBufferBase(GLenum, GLuint, GLuint) {}
+    inline void APIENTRY BindBufferRange(GLenum, GLuint, GLuint, GLintptr, GLsizeiptr) {}
+    inline void APIENTRY BindVertexArray(GLuint) {}
+    inline void APIENTRY EnableVertexAttribArray(GLuint) {}
+    inline void APIENTRY VertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void *) {}
+    inline void APIENTRY VertexAttribIPointer(GLuint, GLint, GLenum, GLsizei, const void *) {}
+
+    inline void APIENTRY BufferData(GLenum, GLsizeiptr size, const void *, GLenum)
+    {
+        counters().bufferUploads++;
+        counters().bufferUploadBytes += (unsigned long)size;
+    }
+
+    inline void APIENTRY BufferSubData(GLenum, GLintptr, GLsizeiptr size, const void *)
+    {
+        counters().bufferUploads++;
+        counters().bufferUploadBytes += (unsigned long)size;
+    }
+
+    inline void APIENTRY CopyBufferSubData(GLenum, GLenum, GLintptr, GLintptr, GLsizeiptr) {}
+
+    // textures
+    // --------
+    inline void APIENTRY ActiveTexture(GLenum) {}
+
+    inline void APIENTRY BindTexture(GLenum, GLuint)
+    {
+        counters().textureBinds++;
+    }
+
+    inline void APIENTRY TexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void *)
+    {
+        counters().textureUploads++;
+    }
+
+    inline void APIENTRY TexImage3D(GLenum, GLint, GLint, GLsizei, GLsizei, GLsizei, GLint, GLenum, GLenum, const void *)
+    {
+        counters().textureUploads++;
+    }
+
+    inline void APIENTRY TexParameteri(GLenum, GLenum, GLint) {}
+    inline void APIENTRY GenerateMipmap(GLenum) {}
+
+    // framebuffers
+    // ------------
+    inline void APIENTRY BindFramebuffer(GLenum, GLuint) {}
+    inline void APIENTRY BindRenderbuffer(GLenum, GLuint) {}
+    inline void APIENTRY RenderbufferStorage(GLenum, GLenum, GLsizei, GLsizei) {}
+    inline void APIENTRY FramebufferRenderbuffer(GLenum, GLenum, GLenum, GLuint) {}
+    inline void APIENTRY FramebufferTexture2D(GLenum, GLenum, GLenum, GLuint, GLint) {}
+    inline void APIENTRY FramebufferTextureLayer(GLenum, GLenum, GLuint, GLint, GLint) {}
+    inline void APIENTRY DrawBuffers(GLsizei, const GLenum *) {}
+    inline void APIENTRY BlitFramebuffer(GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield, GLenum) {}
+    inline void APIENTRY CopyImageSubData(GLuint, GLenum, GLint, GLint, GLint, GLint, GLuint, GLenum, GLint, GLint, GLint, GLint,
+                                          GLsizei, GLsizei, GLsizei) {}
+
+    inline GLenum APIENTRY CheckFramebufferStatus(GLenum)
+    {
+        return GL_FRAMEBUFFER_COMPLETE;
+    }
+
+    // draws
+    // -----
+    inline void APIENTRY DrawArrays(GLenum, GLint, GLsizei)
+    {
+        counters().drawCalls++;
+    }
+
+    inline void APIENTRY DrawElements(GLenum, GLsizei, GLenum, const void *)
+    {
+        counters().drawCalls++;
+    }
+
+    inline void APIENTRY DrawElementsInstanced(GLenum, GLsizei, GLenum, const void *, GLsizei)
+    {
+        counters().drawCalls++;
+    }
+
+    inline void APIENTRY DispatchCompute(GLuint, GLuint, GLuint) {}
+    // not MemoryBarrier: that is a macro in <windows.h>
+    inline void APIENTRY Barrier(GLbitfield) {}
+
+    // queries: always available, always zero time
+    // -------------------------------------------
+    inline void APIENTRY BeginQuery(GLenum, GLuint) {}
+    inline void APIENTRY EndQuery(GLenum) {}
+
+    inline void APIENTRY GetQueryObjectiv(GLuint, GLenum, GLint *params)
+    {
+        *params = GL_TRUE;
+    }
+
+    inline void APIENTRY GetQueryObjectui64v(GLuint, GLenum, GLuint64 *params)
+    {
+        *params = 0;
+    }
+
+    // loader for gladLoadGLLoader
+    // ---------------------------
+    inline void *getProcAddress(const char *name)
+    {
+        static const struct
+        {
+            const char *name;
+            void *proc;
+        } procs[] = {
+            { "glGetString", (void *)&GetString },
+            { "glGetStringi", (void *)&GetStringi },
+            { "glGetIntegerv", (void *)&GetIntegerv },
+            { "glGetError", (void *)&GetError },
+            { "glEnable", (void *)&Enable },
+            { "glDisable", (void *)&Disable },
+            { "glBlendFunc", (void *)&BlendFunc },
+            { "glCullFace", (void *)&CullFace },
+            { "glDepthFunc", (void *)&DepthFunc },
+            { "glDepthMask", (void *)&DepthMask },
+            { "glViewport", (void *)&Viewport },
+            { "glClearColor", (void *)&ClearColor },
+            { "glClear", (void *)&Clear },
+            { "glFinish", (void *)&Finish },
+            { "glFlush", (void *)&Flush },
+            { "glPatchParameteri", (void *)&PatchParameteri },
+            { "glPolygonOffset", (void *)&PolygonOffset },
+            { "glCreateShader", (void *)&CreateShader },
+            { "glCreateProgram", (void *)&CreateProgram },
+            { "glShaderSource", (void *)&ShaderSource },
+            { "glCompileShader", (void *)&CompileShader },
+            { "glAttachShader", (void *)&AttachShader },
+            { "glLinkProgram", (void *)&LinkProgram },
+            { "glDeleteShader", (void *)&DeleteShader },
+            { "glDeleteProgram", (void *)&DeleteProgram },
+            { "glGetShaderiv", (void *)&GetShaderiv },
+            { "glGetProgramiv", (void *)&GetProgramiv },
+            { "glGetShaderInfoLog", (void *)&GetInfoLog },
+            { "glGetProgramInfoLog", (void *)&GetInfoLog },
+            { "glUseProgram", (void *)&UseProgram },
+            { "glGetUniformLocation", (void *)&GetUniformLocation },
+            { "glUniform1i", (void *)&Uniform1i },
+            { "glUniform1f", (void *)&Uniform1f },
+            { "glUniform2f", (void *)&Uniform2f },
+            { "glUniform3f", (void *)&Uniform3f },
+            { "glUniform4f", (void *)&Uniform4f },
+            { "glUniform2fv", (void *)&Uniformfv },
+            { "glUniform3fv", (void *)&Uniformfv },
+            { "glUniform4fv", (void *)&Uniformfv },
+            { "glUniform3iv", (void *)&Uniformiv },
+            { "glUniformMatrix2fv", (void *)&UniformMatrixfv },
+            { "glUniformMatrix3fv", (void *)&UniformMatrixfv },
+            { "glUniformMatrix4fv", (void *)&UniformMatrixfv },
+            { "glGenBuffers", (void *)&GenNames },
+            { "glGenVertexArrays", (void *)&GenNames },
+            { "glGenTextures", (void *)&GenNames },
+            { "glGenFramebuffers", (void *)&GenNames },
+            { "glGenRenderbuffers", (void *)&GenNames },
+            { "glGenQueries", (void *)&GenNames },
+            { "glDeleteBuffers", (void *)&DeleteNames },
+            { "glDeleteVertexArrays", (void *)&DeleteNames },
+            { "glDeleteTextures", (void *)&DeleteNames },
+            { "glDeleteFramebuffers", (void *)&DeleteNames },
+            { "glDeleteRenderbuffers", (void *)&DeleteNames },
+            { "glDeleteQueries", (void *)&DeleteNames },
+            { "glBindBuffer", (void *)&BindBuffer },
+            { "glBindBufferBase", (void *)&BindBufferBase },
+            { "glBindBufferRange", (void *)&BindBufferRange },
+            { "glBindVertexArray", (void *)&BindVertexArray },
+            { "glEnableVertexAttribArray", (void *)&EnableVertexAttribArray },
+            { "glVertexAttribPointer", (void *)&VertexAttribPointer },
+            { "glVertexAttribIPointer", (void *)&VertexAttribIPointer },
+            { "glBufferData", (void *)&BufferData },
+            { "glBufferSubData", (void *)&BufferSubData },
+            { "glCopyBufferSubData", (void *)&CopyBufferSubData },
+            { "glActiveTexture", (void *)&ActiveTexture },
+            { "glBindTexture", (void *)&BindTexture },
+            { "glTexImage2D", (void *)&TexImage2D },
+            { "glTexImage3D", (void *)&TexImage3D },
+            { "glTexParameteri", (void *)&TexParameteri },
+            { "glGenerateMipmap", (void *)&GenerateMipmap },
+            { "glBindFramebuffer", (void *)&BindFramebuffer },
+            { "glBindRenderbuffer", (void *)&BindRenderbuffer },
+            { "glRenderbufferStorage", (void *)&RenderbufferStorage },
+            { "glFramebufferRenderbuffer", (void *)&FramebufferRenderbuffer },
+            { "glFramebufferTexture2D", (void *)&FramebufferTexture2D },
+            { "glFramebufferTextureLayer", (void *)&FramebufferTextureLayer },
+            { "glDrawBuffers", (void *)&DrawBuffers },
+            { "glBlitFramebuffer", (void *)&BlitFramebuffer },
+            { "glCopyImageSubData", (void *)&CopyImageSubData },
+            { "glCheckFramebufferStatus", (void *)&CheckFramebufferStatus },
+            { "glDrawArrays", (void *)&DrawArrays },
+            { "glDrawElements", (void *)&DrawElements },
+            { "glDrawElementsInstanced", (void *)&DrawElementsInstanced },
+            { "glDispatchCompute", (void *)&DispatchCompute },
+            { "glMemoryBarrier", (void *)&Barrier },
+            { "glBeginQuery", (void *)&BeginQuery },
+            { "glEndQuery", (void *)&EndQuery },
+            { "glGetQueryObjectiv", (void *)&GetQueryObjectiv },
+            { "glGetQueryObjectui64v", (void *)&GetQueryObjectui64v },
+        };
+
+        for (const auto &entry : procs)
+        {
+            if (std::strcmp(entry.name, name) == 0)
+                return entry.proc;
+        }
+        return nullptr;
+    }
+}
+
+#endif
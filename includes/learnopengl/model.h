@@ -12,10 +12,14 @@
 
 #include <learnopengl/mesh.h>
 #include <learnopengl/shader.h>
+#include <learnopengl/profiler.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <string>
 #include <fstream>
+#include <functional>
 #include <sstream>
 #include <iostream>
 #include <map>
@@ -24,7 +28,56 @@
 
 using namespace std;
 
-unsigned int TextureFromFile(const char *path, const string &directory, bool gamma = false);
+// where the time of constructing a Model goes, and how much data it produced.
+// GPU upload times are the CPU time spent in the GL calls; drivers may finish the copy later.
+struct ModelLoadStats
+{
+    double importMs = 0.0;          // Assimp::Importer::ReadFile, including post-processing
+    double conversionMs = 0.0;      // aiMesh -> Vertex / index arrays
+    double textureDecodeMs = 0.0;   // stbi_load
+    double textureUploadMs = 0.0;   // glTexImage2D + glGenerateMipmap
+    double bufferUploadMs = 0.0;    // VAO / VBO / EBO creation and glBufferData
+    double totalMs = 0.0;
+
+    unsigned int meshes = 0;
+    size_t vertices = 0;
+    size_t indices = 0;
+    unsigned int textures = 0;
+    size_t vertexBytes = 0;
+    size_t indexBytes = 0;
+    size_t textureBytes = 0;        // decoded texels, level 0 only
+
+    static double millisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void print(const string &name) const
+    {
+        char line[512];
+        std::snprintf(line, sizeof(line),
+            "Model %s: %.1f ms (import %.1f, conversion %.1f, texture decode %.1f, texture upload %.1f, buffer upload %.1f); "
+            "%u meshes, %zu vertices, %zu indices, %u textures, %.1f MiB geometry, %.1f MiB texels",
+            name.c_str(), totalMs, importMs, conversionMs, textureDecodeMs, textureUploadMs, bufferUploadMs,
+            meshes, vertices, indices, textures, (vertexBytes + indexBytes) / 1048576.0, textureBytes / 1048576.0);
+        cout << line << endl;
+    }
+
+    string toJson() const
+    {
+        char json[1024];
+        std::snprintf(json, sizeof(json),
+            "{ \"total_ms\": %.3f, \"import_ms\": %.3f, \"conversion_ms\": %.3f, \"texture_decode_ms\": %.3f, "
+            "\"texture_upload_ms\": %.3f, \"buffer_upload_ms\": %.3f, \"meshes\": %u, \"vertices\": %zu, "
+            "\"indices\": %zu, \"textures\": %u, \"vertex_bytes\": %zu, \"index_bytes\": %zu, \"texture_bytes\": %zu }",
+            totalMs, importMs, conversionMs, textureDecodeMs, textureUploadMs, bufferUploadMs,
+            meshes, vertices, indices, textures, vertexBytes, indexBytes, textureBytes);
+        return json;
+    }
+};
+
+// if texture is given, its width, height and components are set from the image
+unsigned int TextureFromFile(const char *path, const string &directory, bool gamma = false, ModelLoadStats *stats = nullptr, Texture *texture = nullptr);
 
 class Model 
 {
@@ -34,27 +87,71 @@ public:
     vector<Mesh>    meshes;
     string directory;
     bool gammaCorrection;
+    ModelLoadStats loadStats;
 
     // constructor, expects a filepath to a 3D model.
-    Model(string const &path, bool gamma = false) : gammaCorrection(gamma)
+    // Without keepGeometry the vertices and indices are freed once they are on the GPU.
+    Model(string const &path, bool gamma = false, bool keepGeometry = true) : gammaCorrection(gamma)
     {
+        auto start = std::chrono::steady_clock::now();
         loadModel(path);
+        loadStats.totalMs = ModelLoadStats::millisecondsSince(start);
+        loadStats.print(path);
+        if (!keepGeometry)
+        {
+            for (Mesh &mesh : meshes)
+                mesh.releaseGeometry();
+        }
     }
 
     // draws the model, and thus all its meshes
     void Draw(Shader &shader)
     {
+        PROFILE_ZONE("Model::Draw");
         for(unsigned int i = 0; i < meshes.size(); i++)
             meshes[i].Draw(shader);
     }
+
+    // draws the model, calling beforeMesh(i) ahead of meshes[i], e.g. to set per-mesh uniforms
+    void Draw(Shader &shader, const std::function<void(unsigned int)> &beforeMesh)
+    {
+        PROFILE_ZONE("Model::Draw");
+        for (unsigned int i = 0; i < meshes.size(); i++)
+        {
+            beforeMesh(i);
+            meshes[i].Draw(shader);
+        }
+    }
+
+    // draws the positions of all meshes with whatever program is in use (depth-only passes)
+    void DrawPositions()
+    {
+        PROFILE_ZONE("Model::DrawPositions");
+        for (Mesh &mesh : meshes)
+            mesh.DrawPositions();
+    }
+
+    // all meshes plus every texture loaded for the model
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage usage;
+        for (const Mesh &mesh : meshes)
+            usage += mesh.memoryUsage();
+        for (const Texture &texture : textures_loaded)
+            usage.gpuBytes += texture.gpuBytes();
+        return usage;
+    }
     
 private:
     // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
     void loadModel(string const &path)
     {
+        PROFILE_ZONE("Model::loadModel");
         // read file via ASSIMP
         Assimp::Importer importer;
+        auto importStart = std::chrono::steady_clock::now();
         const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_SplitLargeMeshes | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace | aiProcess_PreTransformVertices);
+        loadStats.importMs = ModelLoadStats::millisecondsSince(importStart);
         // check for errors
         if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
         {
@@ -94,6 +191,9 @@ private:
         vector<unsigned int> indices;
         vector<Texture> textures;
 
+        auto conversionStart = std::chrono::steady_clock::now();
+        vertices.reserve(mesh->mNumVertices);
+        indices.reserve(mesh->mNumFaces * 3);
         // walk through each of the mesh's vertices
         for(unsigned int i = 0; i < mesh->mNumVertices; i++)
         {
@@ -145,6 +245,13 @@ private:
             for(unsigned int j = 0; j < face.mNumIndices; j++)
                 indices.push_back(face.mIndices[j]);        
         }
+        loadStats.conversionMs += ModelLoadStats::millisecondsSince(conversionStart);
+        loadStats.meshes++;
+        loadStats.vertices += vertices.size();
+        loadStats.indices += indices.size();
+        loadStats.vertexBytes += vertices.size() * sizeof(Vertex);
+        loadStats.indexBytes += indices.size() * sizeof(unsigned int);
+
         // process materials
         aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];    
         // we assume a convention for sampler names in the shaders. Each diffuse texture should be named
@@ -168,7 +275,10 @@ private:
         textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
         
         // return a mesh object created from the extracted mesh data
-        return Mesh(vertices, indices, textures);
+        auto uploadStart = std::chrono::steady_clock::now();
+        Mesh result(std::move(vertices), std::move(indices), std::move(textures));
+        loadStats.bufferUploadMs += ModelLoadStats::millisecondsSince(uploadStart);
+        return result;
     }
 
     // checks all material textures of a given type and loads the textures if they're not loaded yet.
@@ -195,7 +305,7 @@ private:
             {   // if texture hasn't been loaded already, load it
                 std::cerr << typeName << '\t' << str.C_Str() << std::endl;
                 Texture texture;
-                texture.id = TextureFromFile(str.C_Str(), this->directory);
+                texture.id = TextureFromFile(str.C_Str(), this->directory, false, &loadStats, &texture);
                 texture.type = typeName;
                 texture.path = str.C_Str();
                 textures.push_back(texture);
@@ -207,7 +317,7 @@ private:
 };
 
 
-unsigned int TextureFromFile(const char *path, const string &directory, bool gamma)
+unsigned int TextureFromFile(const char *path, const string &directory, bool gamma, ModelLoadStats *stats, Texture *texture)
 {
     string filename = string(path);
     filename = directory + '/' + filename;
@@ -217,7 +327,10 @@ unsigned int TextureFromFile(const char *path, const string &directory, bool gam
 
     int width, height, nrComponents;
     //std::cerr << std::filesystem::absolute(filename) << std::endl;
+    auto decodeStart = std::chrono::steady_clock::now();
     unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
+    if (stats)
+        stats->textureDecodeMs += ModelLoadStats::millisecondsSince(decodeStart);
     if (data)
     {
         GLenum format;
@@ -228,9 +341,22 @@ unsigned int TextureFromFile(const char *path, const string &directory, bool gam
         else if (nrComponents == 4)
             format = GL_RGBA;
 
+        auto uploadStart = std::chrono::steady_clock::now();
         glBindTexture(GL_TEXTURE_2D, textureID);
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
+        if (texture)
+        {
+            texture->width = width;
+            texture->height = height;
+            texture->components = nrComponents;
+        }
+        if (stats)
+        {
+            stats->textureUploadMs += ModelLoadStats::millisecondsSince(uploadStart);
+            stats->textures++;
+            stats->textureBytes += (size_t)width * height * nrComponents;
+        }
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
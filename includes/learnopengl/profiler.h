@@ -0,0 +1,148 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Low-overhead scoped CPU profiler.
+//
+// PROFILE_ZONE("name") measures the enclosing scope. Each thread appends finished zones to its
+// own fixed-size ring buffer (no locking on the hot path; the oldest zones are overwritten once
+// the ring is full), and Profiler::writeChromeTrace() dumps everything still in the rings as
+// Chrome trace_event JSON (open it in chrome://tracing or https://ui.perfetto.dev).
+//
+// The macros compile to nothing unless ENABLE_PROFILER is defined.
+namespace profiler
+{
+    // zone names must be string literals (or otherwise outlive the profiler)
+    struct Zone
+    {
+        const char *name;
+        uint64_t startNs;
+        uint64_t endNs;
+    };
+
+    const size_t RING_CAPACITY = 1 << 16;
+
+    struct ThreadRing
+    {
+        uint32_t threadId;
+        uint64_t written = 0; // total zones ever pushed; the ring keeps the last RING_CAPACITY
+        std::vector<Zone> zones;
+
+        explicit ThreadRing(uint32_t id) : threadId(id), zones(RING_CAPACITY) {}
+
+        void push(const Zone &zone)
+        {
+            zones[written % RING_CAPACITY] = zone;
+            written++;
+        }
+    };
+
+    inline uint64_t nowNs()
+    {
+        static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    // all rings ever created; rings are never freed so zones of finished threads can still be dumped
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<ThreadRing *> rings;
+    };
+
+    inline Registry &registry()
+    {
+        static Registry instance;
+        return instance;
+    }
+
+    inline ThreadRing &threadRing()
+    {
+        thread_local ThreadRing *ring = nullptr;
+        if (!ring)
+        {
+            Registry &reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            ring = new ThreadRing((uint32_t)reg.rings.size() + 1);
+            reg.rings.push_back(ring);
+        }
+        return *ring;
+    }
+
+    class ScopedZone
+    {
+    public:
+        explicit ScopedZone(const char *name) : name(name), startNs(nowNs()) {}
+
+        ~ScopedZone()
+        {
+            threadRing().push({ name, startNs, nowNs() });
+        }
+
+        ScopedZone(const ScopedZone &) = delete;
+        ScopedZone &operator=(const ScopedZone &) = delete;
+
+    private:
+        const char *name;
+        uint64_t startNs;
+    };
+
+    class Profiler
+    {
+    public:
+#ifdef ENABLE_PROFILER
+        static constexpr bool enabled = true;
+#else
+        static constexpr bool enabled = false;
+#endif
+
+        // writes the buffered zones of every thread as Chrome trace_event JSON.
+        // Meant to be called between frames; zones still being pushed by other threads may be skipped.
+        static bool writeChromeTrace(const std::string &path)
+        {
+            FILE *file = std::fopen(path.c_str(), "w");
+            if (!file)
+            {
+                std::cerr << "ERROR::PROFILER::CANNOT_OPEN_TRACE: " << path << std::endl;
+                return false;
+            }
+
+            std::fprintf(file, "{\"traceEvents\":[\n");
+            bool first = true;
+            Registry &reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            for (const ThreadRing *ring : reg.rings)
+            {
+                uint64_t count = ring->written < RING_CAPACITY ? ring->written : RING_CAPACITY;
+                for (uint64_t i = ring->written - count; i < ring->written; i++)
+                {
+                    const Zone &zone = ring->zones[i % RING_CAPACITY];
+                    std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                        first ? "" : ",\n", zone.name, ring->threadId,
+                        zone.startNs / 1000.0, (zone.endNs - zone.startNs) / 1000.0);
+                    first = false;
+                }
+            }
+            std::fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+            std::fclose(file);
+            return true;
+        }
+    };
+}
+
+#ifdef ENABLE_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) profiler::ScopedZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
+
+#endif
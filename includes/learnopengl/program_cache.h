@@ -0,0 +1,177 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// On-disk cache of linked program binaries (glGetProgramBinary / glProgramBinary), so later
+// launches skip compiling and linking. Entries are keyed by a hash of every stage source, the
+// defines and the GL vendor, renderer and version strings, so a driver update or an edited
+// shader simply misses. A binary the driver rejects is treated as a miss and overwritten.
+// Does nothing when the driver offers no binary formats.
+class ProgramCache
+{
+public:
+    struct Stats
+    {
+        unsigned int hits = 0;
+        unsigned int misses = 0;
+        unsigned int rejected = 0; // found on disk but refused by glProgramBinary
+    };
+
+    // relative to the working directory, like the shaders
+    static std::string &directory()
+    {
+        static std::string dir = "shader_cache";
+        return dir;
+    }
+
+    static bool &enabled()
+    {
+        static bool on = true;
+        return on;
+    }
+
+    static Stats &stats()
+    {
+        static Stats counters;
+        return counters;
+    }
+
+    // sources in stage order; an empty string for an absent stage
+    static std::uint64_t key(const std::vector<std::string> &sources, const std::string &defines)
+    {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (const std::string &source : sources)
+            hash = fnv1a(hash, source + '\x1f');
+        hash = fnv1a(hash, defines + '\x1f');
+        hash = fnv1a(hash, glString(GL_VENDOR) + '\x1f' + glString(GL_RENDERER) + '\x1f' + glString(GL_VERSION));
+        return hash;
+    }
+
+    // call before glLinkProgram so the driver keeps the binary around
+    static void prepare(GLuint program)
+    {
+        if (available())
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    // true when program was linked from the cached binary
+    static bool load(GLuint program, std::uint64_t key)
+    {
+        if (!available())
+            return false;
+        std::ifstream file(path(key), std::ios::binary);
+        Header header;
+        if (!file || !file.read(reinterpret_cast<char *>(&header), sizeof(header))
+            || header.magic != MAGIC || header.key != key || header.length == 0)
+        {
+            stats().misses++;
+            return false;
+        }
+        std::vector<char> binary(header.length);
+        if (!file.read(binary.data(), binary.size()))
+        {
+            stats().misses++;
+            return false;
+        }
+        glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+        GLint success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            stats().rejected++;
+            stats().misses++;
+            return false;
+        }
+        stats().hits++;
+        return true;
+    }
+
+    // writes the binary of a freshly linked program
+    static void store(GLuint program, std::uint64_t key)
+    {
+        if (!available())
+            return;
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+        std::vector<char> binary(length);
+        Header header;
+        header.magic = MAGIC;
+        header.key = key;
+        glGetProgramBinary(program, length, nullptr, &header.format, binary.data());
+        header.length = (std::uint32_t)length;
+
+        std::error_code error;
+        std::filesystem::create_directories(directory(), error);
+        // written aside and renamed so a crash never leaves a truncated entry behind
+        std::string finalPath = path(key);
+        std::string tempPath = finalPath + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file)
+            {
+                std::cout << "ERROR::PROGRAM_CACHE::CANNOT_WRITE: " << tempPath << std::endl;
+                return;
+            }
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(binary.data(), binary.size());
+        }
+        std::filesystem::rename(tempPath, finalPath, error);
+    }
+
+private:
+    static const std::uint32_t MAGIC = 0x42504c47; // "GLPB"
+
+    struct Header
+    {
+        std::uint32_t magic = 0;
+        GLenum format = 0;
+        std::uint64_t key = 0;
+        std::uint32_t length = 0;
+        std::uint32_t pad = 0;
+    };
+
+    static bool available()
+    {
+        if (!enabled())
+            return false;
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    }
+
+    static std::string path(std::uint64_t key)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return directory() + "/" + name;
+    }
+
+    static std::string glString(GLenum name)
+    {
+        const GLubyte *value = glGetString(name);
+        return value ? (const char *)value : "";
+    }
+
+    static std::uint64_t fnv1a(std::uint64_t hash, const std::string &data)
+    {
+        for (unsigned char c : data)
+        {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+};
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef SHADER_COMPILER_H
+#define SHADER_COMPILER_H
+
+#include <glad/glad.h>
+
+#include <cstring>
+
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// GL_KHR_parallel_shader_compile (or GL_ARB_parallel_shader_compile), which our glad was
+// generated without, so the entry point is loaded here. With it the driver compiles and links
+// on its own threads: glCompileShader and glLinkProgram return at once and only a status query
+// waits. Shader therefore submits its program in the constructor and checks it in finish(), so
+// every program can be submitted before the first one is waited for.
+// Without the extension submission still happens up front; the driver just does the work inline.
+class ShaderCompiler
+{
+public:
+    struct Stats
+    {
+        unsigned int programs = 0; // compiled from source (cache hits are not counted)
+        double submitMs = 0.0;     // reading, compiling and linking calls
+        double waitMs = 0.0;       // status queries in Shader::finish()
+        unsigned int filesRead = 0; // shader files read from disk rather than embedded
+        unsigned int spirvPrograms = 0; // linked from SPIR-V modules (counted in programs too)
+    };
+
+    // call once after gladLoadGLLoader, with the same loader
+    static bool init(GLADloadproc load)
+    {
+        typedef void (APIENTRYP MaxThreadsProc)(GLuint count);
+        MaxThreadsProc maxThreads = nullptr;
+        if (hasExtension("GL_KHR_parallel_shader_compile"))
+            maxThreads = (MaxThreadsProc)load("glMaxShaderCompilerThreadsKHR");
+        else if (hasExtension("GL_ARB_parallel_shader_compile"))
+            maxThreads = (MaxThreadsProc)load("glMaxShaderCompilerThreadsARB");
+        spirv() = GLAD_GL_VERSION_4_6 && glShaderBinary && glSpecializeShader;
+        parallel() = maxThreads != nullptr;
+        if (parallel())
+        {
+            // 0xFFFFFFFF lets the driver pick its own maximum
+            maxThreads(0xFFFFFFFFu);
+            GLint threads = 0;
+            glGetIntegerv(GL_MAX_SHADER_COMPILER_THREADS_KHR, &threads);
+            maxCompilerThreads() = threads;
+        }
+        return parallel();
+    }
+
+    static bool &parallel()
+    {
+        static bool available = false;
+        return available;
+    }
+
+    // whether the driver loads SPIR-V shaders (GL 4.6: glShaderBinary + glSpecializeShader)
+    static bool &spirv()
+    {
+        static bool available = false;
+        return available;
+    }
+
+    // as read back after init(): -1 (0xFFFFFFFF) means the driver picks
+    static GLint &maxCompilerThreads()
+    {
+        static GLint threads = 0;
+        return threads;
+    }
+
+    // false makes every Shader wait for its own program before returning, as before
+    static bool &deferred()
+    {
+        static bool on = true;
+        return on;
+    }
+
+    static Stats &stats()
+    {
+        static Stats counters;
+        return counters;
+    }
+
+    // whether the driver finished compiling and linking program; never waits
+    static bool completed(GLuint program)
+    {
+        if (!parallel())
+            return true;
+        GLint done = GL_TRUE;
+        glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &done);
+        return done == GL_TRUE;
+    }
+
+private:
+    static bool hasExtension(const char *name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            const GLubyte *extension = glGetStringi(GL_EXTENSIONS, (GLuint)i);
+            if (extension && std::strcmp((const char *)extension, name) == 0)
+                return true;
+        }
+        return false;
+    }
+};
+
+#endif
@@ -4,95 +4,123 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <learnopengl/program_cache.h>
+#include <learnopengl/shader_compiler.h>
+#ifdef EMBED_SHADERS
+// generated at build time from the shader files (cmake/embed_shaders.cmake)
+#include <embedded_shaders.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <regex>
+#include <unordered_map>
+#include <vector>
 
 class Shader
 {
 public:
     unsigned int ID;
-    // constructor generates the shader on the fly
+
+    // a uniform location resolved once with uniform() and reused every frame;
+    // -1 (ignored by glUniform*) when the program has no such active uniform
+    struct Uniform
+    {
+        GLint location = -1;
+    };
+    // uploads made and skipped by the setters of every Shader; see changed()
+    struct UniformStats
+    {
+        unsigned long long issued = 0;
+        unsigned long long skipped = 0;
+    };
+    // constructor generates the shader on the fly. Compiling and linking are only submitted:
+    // errors are reported by finish(), which use() and uniform() call on first use
+    // (see learnopengl/shader_compiler.h). Every name in defines is #defined in all stages.
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr,
-           const char* tessControlPath = nullptr, const char* tessEvalPath = nullptr)
+           const char* tessControlPath = nullptr, const char* tessEvalPath = nullptr,
+           const std::vector<std::string> &defines = {})
     {
+        auto submitStart = std::chrono::steady_clock::now();
         // 1. retrieve the vertex/fragment source code from filePath
         std::string vertexCode;
         std::string fragmentCode;
         std::string geometryCode;
         std::string tessControlCode;
         std::string tessEvalCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        std::ifstream gShaderFile;
-        std::ifstream tcShaderFile;
-        std::ifstream teShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        gShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        tcShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        teShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
         try
         {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
+            // #include "file" lines are replaced by the file's contents
+            vertexCode = loadSource(vertexPath);
+            fragmentCode = loadSource(fragmentPath);
             // if geometry shader path is present, also load a geometry shader
             if(geometryPath != nullptr)
-            {
-                gShaderFile.open(geometryPath);
-                std::stringstream gShaderStream;
-                gShaderStream << gShaderFile.rdbuf();
-                gShaderFile.close();
-                geometryCode = gShaderStream.str();
-            }
-            if(tessControlPath != nullptr) {
-                tcShaderFile.open(tessControlPath);
-                std::stringstream tcShaderStream;
-                tcShaderStream << tcShaderFile.rdbuf();
-                tcShaderFile.close();
-                tessControlCode = tcShaderStream.str();
-            }
-            if(tessEvalPath != nullptr) {
-                teShaderFile.open(tessEvalPath);
-                std::stringstream teShaderStream;
-                teShaderStream << teShaderFile.rdbuf();
-                teShaderFile.close();
-                tessEvalCode = teShaderStream.str();
-            }
+                geometryCode = loadSource(geometryPath);
+            if(tessControlPath != nullptr)
+                tessControlCode = loadSource(tessControlPath);
+            if(tessEvalPath != nullptr)
+                tessEvalCode = loadSource(tessEvalPath);
         }
         catch (std::ifstream::failure& e)
         {
             std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " 
                 << e.what() << std::endl;
         }
+        // the SPIR-V modules built for these stages, empty when any is missing
+        std::vector<SpirvStage> spirvStages = findSpirvStages({ { GL_VERTEX_SHADER, "VERTEX", vertexPath, &vertexCode },
+            { GL_FRAGMENT_SHADER, "FRAGMENT", fragmentPath, &fragmentCode }, { GL_GEOMETRY_SHADER, "GEOMETRY", geometryPath, &geometryCode },
+            { GL_TESS_CONTROL_SHADER, "TESS_CONTROL", tessControlPath, &tessControlCode },
+            { GL_TESS_EVALUATION_SHADER, "TESS_EVALUATION", tessEvalPath, &tessEvalCode } }, defines);
+        std::string defineLines;
+        for (const std::string &define : defines)
+            defineLines += "#define " + define + "\n";
+        if (!defineLines.empty())
+        {
+            vertexCode = insertDefines(vertexCode, defineLines);
+            fragmentCode = insertDefines(fragmentCode, defineLines);
+            geometryCode = insertDefines(geometryCode, defineLines);
+            tessControlCode = insertDefines(tessControlCode, defineLines);
+            tessEvalCode = insertDefines(tessEvalCode, defineLines);
+        }
+        // 2. reuse the binary of a previous run when nothing changed
+        std::uint64_t cacheKey = ProgramCache::key({ vertexCode, fragmentCode, geometryCode, tessControlCode, tessEvalCode },
+                                                   spirvStages.empty() ? defineLines : defineLines + "SPIR-V");
+        ID = glCreateProgram();
+        if (!spirvStages.empty())
+            declareUniformLocations({ &vertexCode, &fragmentCode, &geometryCode, &tessControlCode, &tessEvalCode });
+        if (ProgramCache::load(ID, cacheKey))
+        {
+            cacheUniformLocations();
+            return;
+        }
+        if (!spirvStages.empty())
+        {
+            linkSpirv(spirvStages);
+            submitted(cacheKey, submitStart);
+            return;
+        }
         const char* vShaderCode = vertexCode.c_str();
         const char * fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
+        // 3. compile shaders
         unsigned int vertex, fragment;
         // vertex shader
         vertex = glCreateShader(GL_VERTEX_SHADER);
         glShaderSource(vertex, 1, &vShaderCode, NULL);
         glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
+        pendingStages.push_back({ vertex, "VERTEX" });
         // fragment Shader
         fragment = glCreateShader(GL_FRAGMENT_SHADER);
         glShaderSource(fragment, 1, &fShaderCode, NULL);
         glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
+        pendingStages.push_back({ fragment, "FRAGMENT" });
         // if geometry shader is given, compile geometry shader
         unsigned int geometry;
         if(geometryPath != nullptr)
@@ -101,7 +129,7 @@ public:
             geometry = glCreateShader(GL_GEOMETRY_SHADER);
             glShaderSource(geometry, 1, &gShaderCode, NULL);
             glCompileShader(geometry);
-            checkCompileErrors(geometry, "GEOMETRY");
+            pendingStages.push_back({ geometry, "GEOMETRY" });
         }
         // if tessellation shader is given, compile tessellation shader
         unsigned int tessControl;
@@ -111,7 +139,7 @@ public:
             tessControl = glCreateShader(GL_TESS_CONTROL_SHADER);
             glShaderSource(tessControl, 1, &tcShaderCode, NULL);
             glCompileShader(tessControl);
-            checkCompileErrors(tessControl, "TESS_CONTROL");
+            pendingStages.push_back({ tessControl, "TESS_CONTROL" });
         }
         unsigned int tessEval;
         if(tessEvalPath != nullptr)
@@ -120,10 +148,9 @@ public:
             tessEval = glCreateShader(GL_TESS_EVALUATION_SHADER);
             glShaderSource(tessEval, 1, &teShaderCode, NULL);
             glCompileShader(tessEval);
-            checkCompileErrors(tessEval, "TESS_EVALUATION");
+            pendingStages.push_back({ tessEval, "TESS_EVALUATION" });
         }
         // shader Program
-        ID = glCreateProgram();
         glAttachShader(ID, vertex);
         glAttachShader(ID, fragment);
         if(geometryPath != nullptr)
@@ -132,81 +159,546 @@ public:
             glAttachShader(ID, tessControl);
         if(tessEvalPath != nullptr)
             glAttachShader(ID, tessEval);
+        ProgramCache::prepare(ID);
         glLinkProgram(ID);
+        submitted(cacheKey, submitStart);
+    }
+    // constructor for a compute program
+    // ------------------------------------------------------------------------
+    explicit Shader(const char* computePath)
+    {
+        auto submitStart = std::chrono::steady_clock::now();
+        std::string computeCode;
+        try
+        {
+            computeCode = loadSource(computePath);
+        }
+        catch (std::ifstream::failure& e)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: "
+                << e.what() << std::endl;
+        }
+        std::vector<SpirvStage> spirvStages = findSpirvStages({ { GL_COMPUTE_SHADER, "COMPUTE", computePath, &computeCode } }, {});
+        std::uint64_t cacheKey = ProgramCache::key({ computeCode }, spirvStages.empty() ? "" : "SPIR-V");
+        ID = glCreateProgram();
+        if (!spirvStages.empty())
+            declareUniformLocations({ &computeCode });
+        if (ProgramCache::load(ID, cacheKey))
+        {
+            cacheUniformLocations();
+            return;
+        }
+        if (!spirvStages.empty())
+        {
+            linkSpirv(spirvStages);
+            submitted(cacheKey, submitStart);
+            return;
+        }
+        const char * cShaderCode = computeCode.c_str();
+        unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(compute, 1, &cShaderCode, NULL);
+        glCompileShader(compute);
+        pendingStages.push_back({ compute, "COMPUTE" });
+        glAttachShader(ID, compute);
+        ProgramCache::prepare(ID);
+        glLinkProgram(ID);
+        submitted(cacheKey, submitStart);
+    }
+    // waits for the submitted program, reports compile and link errors and looks up the
+    // uniforms; does nothing after the first call or for a program loaded from the cache
+    // ------------------------------------------------------------------------
+    void finish()
+    {
+        if (!pending)
+            return;
+        auto waitStart = std::chrono::steady_clock::now();
+        for (const PendingStage &stage : pendingStages)
+        {
+            checkCompileErrors(stage.shader, stage.type);
+            // delete the shaders as they're linked into our program now and no longer necessary
+            glDeleteShader(stage.shader);
+        }
+        pendingStages.clear();
         checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-        if(geometryPath != nullptr)
-            glDeleteShader(geometry);
+        storeInCache(pendingCacheKey);
+        cacheUniformLocations();
+        pending = false;
+        ShaderCompiler::stats().waitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+    }
+    // true once finish() would not wait for the driver
+    // ------------------------------------------------------------------------
+    bool ready() const
+    {
+        return !pending || ShaderCompiler::completed(ID);
+    }
+    // when not empty, shader files are read from this directory on disk, so edits apply without
+    // a rebuild; otherwise they come from the executable (built with EMBED_SHADERS) or from the
+    // working directory. Initialized from the SHADER_DIR environment variable.
+    static std::string &sourceDirectory()
+    {
+        static std::string directory = std::getenv("SHADER_DIR") ? std::getenv("SHADER_DIR") : "";
+        return directory;
+    }
 
+    // directory of the SPIR-V modules compiled at build time (cmake/compile_spirv.cmake). A program
+    // whose stages all have a module there is linked from them with glShaderBinary and
+    // glSpecializeShader, so the driver never parses its GLSL; otherwise it is compiled from GLSL.
+    // Empty (the default) or a sourceDirectory() override turns this off.
+    static std::string &spirvDirectory()
+    {
+        static std::string directory;
+        return directory;
+    }
+
+    // false sends every value, as before the shadow state existed (for comparison)
+    static bool &shadowUniforms()
+    {
+        static bool on = true;
+        return on;
+    }
+
+    static UniformStats &uniformStats()
+    {
+        static UniformStats counters;
+        return counters;
+    }
+    // resolves a uniform name to a handle for the typed setters below
+    // ------------------------------------------------------------------------
+    Uniform uniform(const std::string &name)
+    {
+        finish();
+        return Uniform{ location(name) };
     }
     // activate the shader
     // ------------------------------------------------------------------------
     void use()
     {
+        if (pending)
+            finish();
         glUseProgram(ID);
     }
     // utility uniform functions
     // ------------------------------------------------------------------------
     void setBool(const std::string &name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        setBool(Uniform{ location(name) }, value);
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string &name, int value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        setInt(Uniform{ location(name) }, value);
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string &name, float value) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        setFloat(Uniform{ location(name) }, value);
     }
     // ------------------------------------------------------------------------
     void setVec2(const std::string &name, const glm::vec2 &value) const
     {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        setVec2(Uniform{ location(name) }, value);
     }
     void setVec2(const std::string &name, float x, float y) const
     {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+        setVec2(Uniform{ location(name) }, glm::vec2(x, y));
     }
     // ------------------------------------------------------------------------
     void setVec3(const std::string &name, const glm::vec3 &value) const
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        setVec3(Uniform{ location(name) }, value);
     }
     void setVec3(const std::string &name, float x, float y, float z) const
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        setVec3(Uniform{ location(name) }, glm::vec3(x, y, z));
     }
     // ------------------------------------------------------------------------
     void setVec4(const std::string &name, const glm::vec4 &value) const
     {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        setVec4(Uniform{ location(name) }, value);
     }
     void setVec4(const std::string &name, float x, float y, float z, float w)
     {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        setVec4(Uniform{ location(name) }, glm::vec4(x, y, z, w));
+    }
+    // ------------------------------------------------------------------------
+    void setIVec3(const std::string &name, const glm::ivec3 &value) const
+    {
+        setIVec3(Uniform{ location(name) }, value);
     }
     // ------------------------------------------------------------------------
     void setMat2(const std::string &name, const glm::mat2 &mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat2(Uniform{ location(name) }, mat);
     }
     // ------------------------------------------------------------------------
     void setMat3(const std::string &name, const glm::mat3 &mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat3(Uniform{ location(name) }, mat);
     }
     // ------------------------------------------------------------------------
     void setMat4(const std::string &name, const glm::mat4 &mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat4(Uniform{ location(name) }, mat);
+    }
+    // setters taking a pre-resolved handle. A value bit-identical to the one last sent to the
+    // same location is not sent again, so the program must be in use (as for any glUniform*)
+    // whenever one of its setters is called.
+    // ------------------------------------------------------------------------
+    void setBool(Uniform uniform, bool value) const
+    {
+        setInt(uniform, (int)value);
+    }
+    void setInt(Uniform uniform, int value) const
+    {
+        if (changed(uniform.location, value))
+            glUniform1i(uniform.location, value);
+    }
+    void setFloat(Uniform uniform, float value) const
+    {
+        if (changed(uniform.location, value))
+            glUniform1f(uniform.location, value);
+    }
+    void setVec2(Uniform uniform, const glm::vec2 &value) const
+    {
+        if (changed(uniform.location, value))
+            glUniform2fv(uniform.location, 1, &value[0]);
+    }
+    void setVec3(Uniform uniform, const glm::vec3 &value) const
+    {
+        if (changed(uniform.location, value))
+            glUniform3fv(uniform.location, 1, &value[0]);
+    }
+    void setVec4(Uniform uniform, const glm::vec4 &value) const
+    {
+        if (changed(uniform.location, value))
+            glUniform4fv(uniform.location, 1, &value[0]);
+    }
+    void setIVec3(Uniform uniform, const glm::ivec3 &value) const
+    {
+        if (changed(uniform.location, value))
+            glUniform3iv(uniform.location, 1, &value[0]);
+    }
+    void setMat2(Uniform uniform, const glm::mat2 &mat) const
+    {
+        if (changed(uniform.location, mat))
+            glUniformMatrix2fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
+    }
+    void setMat3(Uniform uniform, const glm::mat3 &mat) const
+    {
+        if (changed(uniform.location, mat))
+            glUniformMatrix3fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
+    }
+    void setMat4(Uniform uniform, const glm::mat4 &mat) const
+    {
+        if (changed(uniform.location, mat))
+            glUniformMatrix4fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
     }
 
 private:
+    struct PendingStage
+    {
+        GLuint shader;
+        const char *type;
+    };
+
+    struct StageSource
+    {
+        GLenum type;
+        const char *typeName;
+        const char *path; // nullptr for an absent stage
+        const std::string *code;
+    };
+
+    struct SpirvStage
+    {
+        GLenum type;
+        const char *typeName;
+        std::string modulePath;
+        std::vector<GLuint> constantIds;
+        std::vector<GLuint> constantValues;
+    };
+
+    // Modules are named after the stage file plus ".NAME" for every define that selects code in
+    // it (in the order of defines), e.g. "bezier_surface.fs.TEXTURED.spv". A define the stage
+    // declares as a specialization constant ("layout (constant_id = N) const bool NAME_ENABLED")
+    // is passed to glSpecializeShader instead, so one module covers it on and off.
+    // ------------------------------------------------------------------------
+    static std::vector<SpirvStage> findSpirvStages(const std::vector<StageSource> &stages, const std::vector<std::string> &defines)
+    {
+        std::vector<SpirvStage> found;
+        if (spirvDirectory().empty() || !sourceDirectory().empty() || !ShaderCompiler::spirv())
+            return found;
+        static const std::regex constantDeclaration("constant_id\\s*=\\s*(\\d+)\\s*\\)\\s*const\\s+bool\\s+(\\w+)_ENABLED");
+        for (const StageSource &stage : stages)
+        {
+            if (stage.path == nullptr)
+                continue;
+            SpirvStage spirv{ stage.type, stage.typeName, spirvDirectory() + "/" + stage.path, {}, {} };
+            std::vector<std::string> constants;
+            for (std::sregex_iterator match(stage.code->begin(), stage.code->end(), constantDeclaration), end; match != end; ++match)
+            {
+                std::string name = (*match)[2];
+                constants.push_back(name);
+                spirv.constantIds.push_back((GLuint)std::stoul((*match)[1]));
+                spirv.constantValues.push_back(std::find(defines.begin(), defines.end(), name) != defines.end());
+            }
+            for (const std::string &define : defines)
+                if (std::find(constants.begin(), constants.end(), define) == constants.end() && mentions(*stage.code, define))
+                    spirv.modulePath += "." + define;
+            spirv.modulePath += ".spv";
+            if (!std::ifstream(spirv.modulePath, std::ios::binary))
+                return {};
+            found.push_back(spirv);
+        }
+        return found;
+    }
+
+    // whether word occurs in source as a whole identifier
+    static bool mentions(const std::string &source, const std::string &word)
+    {
+        auto identifier = [](char c) { return std::isalnum((unsigned char)c) || c == '_'; };
+        for (std::string::size_type at = source.find(word); at != std::string::npos; at = source.find(word, at + 1))
+        {
+            std::string::size_type after = at + word.size();
+            if ((at == 0 || !identifier(source[at - 1])) && (after == source.size() || !identifier(source[after])))
+                return true;
+        }
+        return false;
+    }
+
+    void linkSpirv(const std::vector<SpirvStage> &stages)
+    {
+        for (const SpirvStage &stage : stages)
+        {
+            std::ifstream file(stage.modulePath, std::ios::binary);
+            std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            GLuint shader = glCreateShader(stage.type);
+            glShaderBinary(1, &shader, GL_SHADER_BINARY_FORMAT_SPIR_V, binary.data(), (GLsizei)binary.size());
+            glSpecializeShader(shader, "main", (GLuint)stage.constantIds.size(), stage.constantIds.data(), stage.constantValues.data());
+            pendingStages.push_back({ shader, stage.typeName });
+            glAttachShader(ID, shader);
+        }
+        ProgramCache::prepare(ID);
+        glLinkProgram(ID);
+        ShaderCompiler::stats().spirvPrograms++;
+    }
+
+    // a SPIR-V program has no uniform names to introspect, so its uniforms are found from the
+    // "layout (location = N) uniform type name;" declarations of its GLSL sources
+    // ------------------------------------------------------------------------
+    void declareUniformLocations(const std::vector<const std::string *> &sources)
+    {
+        static const std::regex declaration("layout\\s*\\(\\s*location\\s*=\\s*(\\d+)\\s*\\)\\s*uniform\\s+\\w+\\s+(\\w+)\\s*;");
+        for (const std::string *source : sources)
+            for (std::sregex_iterator match(source->begin(), source->end(), declaration), end; match != end; ++match)
+                uniformLocations[(*match)[2]] = (GLint)std::stoi((*match)[1]);
+    }
+
+    // the value last uploaded to each location; size 0 when none has been yet
+    struct ShadowValue
+    {
+        unsigned char size = 0;
+        unsigned char bytes[sizeof(glm::mat4)];
+    };
+    mutable std::vector<ShadowValue> shadow;
+
+    // false when value matches what location already holds, otherwise records it so the
+    // caller uploads it. Locations of -1 are neither uploaded nor counted.
+    template <typename T>
+    bool changed(GLint location, const T &value) const
+    {
+        static_assert(sizeof(T) <= sizeof(ShadowValue::bytes), "uniform value too large for the shadow state");
+        if (location < 0)
+            return false;
+        UniformStats &stats = uniformStats();
+        if (!shadowUniforms())
+        {
+            stats.issued++;
+            return true;
+        }
+        if ((std::size_t)location >= shadow.size())
+            shadow.resize(location + 1);
+        ShadowValue &last = shadow[location];
+        if (last.size == sizeof(T) && std::memcmp(last.bytes, &value, sizeof(T)) == 0)
+        {
+            stats.skipped++;
+            return false;
+        }
+        last.size = sizeof(T);
+        std::memcpy(last.bytes, &value, sizeof(T));
+        stats.issued++;
+        return true;
+    }
+
+    // set between the constructor submitting the program and finish()
+    bool pending = false;
+    std::vector<PendingStage> pendingStages;
+    std::uint64_t pendingCacheKey = 0;
+
+    // every active uniform of the linked program, so setters never ask the driver; a name the
+    // introspection did not report is looked up once and cached, even when it is -1
+    mutable std::unordered_map<std::string, GLint> uniformLocations;
+
+    GLint location(const std::string &name) const
+    {
+        auto found = uniformLocations.find(name);
+        if (found != uniformLocations.end())
+            return found->second;
+        // not linked yet: nothing to resolve against
+        if (pending)
+            return -1;
+        // drivers without introspection (the mock loader) still resolve names this way
+        GLint uniformLocation = glGetUniformLocation(ID, name.c_str());
+        uniformLocations.emplace(name, uniformLocation);
+        return uniformLocation;
+    }
+
+    // introspects the active uniforms once after linking. Arrays of basic types are reported
+    // as "name[0]"; they are also stored as "name" and with every other index.
+    // ------------------------------------------------------------------------
+    void cacheUniformLocations()
+    {
+        GLint count = 0;
+        GLint maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::string name(maxLength > 0 ? maxLength : 1, '\0');
+        for (GLint i = 0; i < count; i++)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, &name[0]);
+            std::string uniformName = name.substr(0, length);
+            GLint uniformLocation = glGetUniformLocation(ID, uniformName.c_str());
+            // uniforms inside blocks have no location
+            if (uniformLocation < 0)
+                continue;
+            uniformLocations[uniformName] = uniformLocation;
+            std::string::size_type bracket = uniformName.rfind("[0]");
+            if (bracket != std::string::npos && bracket + 3 == uniformName.size())
+            {
+                std::string base = uniformName.substr(0, bracket);
+                uniformLocations[base] = uniformLocation;
+                for (GLint element = 1; element < size; element++)
+                {
+                    std::string elementName = base + "[" + std::to_string(element) + "]";
+                    uniformLocations[elementName] = glGetUniformLocation(ID, elementName.c_str());
+                }
+            }
+        }
+    }
+
+    // reads a shader file and splices in every file named by an #include "file" line, resolved
+    // relative to the including file. A file is included once per stage (like #pragma once).
+    // #line directives keep compiler messages at "<source>:<line>", where source 0 is the stage's
+    // own file and 1, 2, ... the included files in the order they were first included.
+    // Throws std::ifstream::failure when a file cannot be read.
+    // ------------------------------------------------------------------------
+    static std::string loadSource(const std::string &path)
+    {
+        std::vector<std::string> included;
+        return expandIncludes(path, included);
+    }
+
+    // the copy compiled into the executable when there is one and sourceDirectory() is empty,
+    // otherwise the file on disk
+    static std::string readSource(const std::string &path)
+    {
+#ifdef EMBED_SHADERS
+        if (sourceDirectory().empty())
+        {
+            for (const EmbeddedShader &embedded : EMBEDDED_SHADERS)
+                if (embedded.path == path)
+                    return std::string(embedded.source);
+        }
+#endif
+        std::string fullPath = sourceDirectory().empty() ? path : sourceDirectory() + "/" + path;
+        std::ifstream file;
+        file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        file.open(fullPath);
+        std::stringstream stream;
+        stream << file.rdbuf();
+        file.close();
+        ShaderCompiler::stats().filesRead++;
+        return stream.str();
+    }
+
+    static std::string expandIncludes(const std::string &path, std::vector<std::string> &included)
+    {
+        std::istringstream lines(readSource(path));
+        int sourceNumber = (int)included.size();
+        included.push_back(path);
+        std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+
+        std::string result;
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(lines, line))
+        {
+            lineNumber++;
+            std::string::size_type start = line.find_first_not_of(" \t");
+            if (start == std::string::npos || line.compare(start, 8, "#include") != 0)
+            {
+                result += line + "\n";
+                continue;
+            }
+            std::string::size_type open = line.find('"', start + 8);
+            std::string::size_type close = open == std::string::npos ? open : line.find('"', open + 1);
+            if (close == std::string::npos)
+            {
+                std::cout << "ERROR::SHADER::INVALID_INCLUDE: " << path << ":" << lineNumber << ": " << line << std::endl;
+                continue;
+            }
+            std::string includePath = directory + line.substr(open + 1, close - open - 1);
+            if (std::find(included.begin(), included.end(), includePath) == included.end())
+            {
+                result += "#line 1 " + std::to_string(included.size()) + "\n";
+                result += expandIncludes(includePath, included);
+            }
+            result += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(sourceNumber) + "\n";
+        }
+        return result;
+    }
+
+    // #define lines must follow #version; #line keeps error messages pointing at the file's lines
+    // ------------------------------------------------------------------------
+    static std::string insertDefines(const std::string &source, const std::string &defineLines)
+    {
+        std::string::size_type version = source.find("#version");
+        if (version == std::string::npos)
+            return source;
+        std::string::size_type lineEnd = source.find('\n', version);
+        if (lineEnd == std::string::npos)
+            return source + "\n" + defineLines;
+        int nextLine = 2 + (int)std::count(source.begin(), source.begin() + lineEnd, '\n');
+        return source.substr(0, lineEnd + 1) + defineLines + "#line " + std::to_string(nextLine) + "\n"
+            + source.substr(lineEnd + 1);
+    }
+
+    // end of a constructor that compiled from source
+    // ------------------------------------------------------------------------
+    void submitted(std::uint64_t cacheKey, std::chrono::steady_clock::time_point submitStart)
+    {
+        pending = true;
+        pendingCacheKey = cacheKey;
+        ShaderCompiler::Stats &stats = ShaderCompiler::stats();
+        stats.programs++;
+        stats.submitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - submitStart).count();
+        if (!ShaderCompiler::deferred())
+            finish();
+    }
+
+    // only successfully linked programs go to the binary cache
+    // ------------------------------------------------------------------------
+    void storeInCache(std::uint64_t cacheKey)
+    {
+        GLint success = 0;
+        glGetProgramiv(ID, GL_LINK_STATUS, &success);
+        if (success)
+            ProgramCache::store(ID, cacheKey);
+    }
+
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
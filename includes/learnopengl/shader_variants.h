@@ -0,0 +1,115 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include <learnopengl/shader_t.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Compiled variants of one shader program, keyed by a feature bitmask: bit i adds
+// "#define features[i]" to every stage, so a feature the shader tests with #ifdef costs nothing
+// when it is off, where a uniform branch would be evaluated per fragment (or per light).
+// A variant is compiled the first time it is asked for and kept for the lifetime of the object;
+// the program cache stores each variant's binary under its own key.
+class ShaderVariants
+{
+public:
+    // run once on every new variant before it is returned, for uniforms that never change
+    // (sampler units); the variant's program is in use when it is called
+    typedef std::function<void(Shader &)> Setup;
+
+    // the precompile variants are submitted right away, so they build while the caller loads the rest
+    ShaderVariants(std::vector<std::string> features, const std::vector<unsigned int> &precompile, const char *vertexPath,
+                   const char *fragmentPath, const char *geometryPath = nullptr, const char *tessControlPath = nullptr,
+                   const char *tessEvalPath = nullptr)
+        : features(std::move(features)),
+          vertexPath(vertexPath), fragmentPath(fragmentPath),
+          geometryPath(geometryPath ? geometryPath : ""),
+          tessControlPath(tessControlPath ? tessControlPath : ""),
+          tessEvalPath(tessEvalPath ? tessEvalPath : "")
+    {
+        for (unsigned int mask : precompile)
+            variant(mask);
+    }
+
+    ShaderVariants(std::vector<std::string> features, unsigned int precompile, const char *vertexPath, const char *fragmentPath,
+                   const char *geometryPath = nullptr, const char *tessControlPath = nullptr,
+                   const char *tessEvalPath = nullptr)
+        : ShaderVariants(std::move(features), std::vector<unsigned int>{ precompile }, vertexPath, fragmentPath,
+                         geometryPath, tessControlPath, tessEvalPath)
+    {
+    }
+
+    void onCreate(Setup setup)
+    {
+        this->setup = std::move(setup);
+    }
+
+    // submits a variant without waiting for it, so it compiles while other work runs
+    void prepare(unsigned int mask)
+    {
+        variant(mask);
+    }
+
+    // the variant for mask, compiled now if this is the first request
+    Shader &get(unsigned int mask)
+    {
+        Variant &found = variant(mask);
+        if (!found.initialized)
+        {
+            found.initialized = true;
+            if (setup)
+            {
+                found.shader->use();
+                setup(*found.shader);
+            }
+        }
+        return *found.shader;
+    }
+
+    std::size_t compiledCount() const
+    {
+        return variants.size();
+    }
+
+private:
+    struct Variant
+    {
+        std::unique_ptr<Shader> shader;
+        bool initialized = false;
+    };
+
+    std::vector<std::string> features;
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::string geometryPath;
+    std::string tessControlPath;
+    std::string tessEvalPath;
+    Setup setup;
+    std::map<unsigned int, Variant> variants;
+
+    Variant &variant(unsigned int mask)
+    {
+        Variant &found = variants[mask];
+        if (!found.shader)
+        {
+            std::vector<std::string> defines;
+            for (std::size_t i = 0; i < features.size(); i++)
+                if (mask & (1u << i))
+                    defines.push_back(features[i]);
+            found.shader = std::make_unique<Shader>(vertexPath.c_str(), fragmentPath.c_str(), optional(geometryPath),
+                                                    optional(tessControlPath), optional(tessEvalPath), defines);
+        }
+        return found;
+    }
+
+    static const char *optional(const std::string &path)
+    {
+        return path.empty() ? nullptr : path.c_str();
+    }
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef STORAGE_BUFFER_H
+#define STORAGE_BUFFER_H
+
+#include <glad/glad.h>
+
+#include <vector>
+
+// A shader storage buffer holding an array of T, bound to a fixed binding point.
+// T must match the std430 layout of the element of the GLSL unsized array declared with
+// layout (std430, binding = N) buffer. The buffer grows when more elements are uploaded than
+// it holds and never shrinks, so uploading the same number of elements every frame only
+// rewrites the data. Needs a current GL context.
+template <typename T>
+class StorageBuffer
+{
+public:
+    explicit StorageBuffer(GLuint binding) : binding(binding), capacity(0), count(0)
+    {
+        glGenBuffers(1, &ID);
+        // a buffer without a data store cannot be bound; start with room for one element
+        reserve(1);
+    }
+
+    ~StorageBuffer()
+    {
+        glDeleteBuffers(1, &ID);
+    }
+
+    StorageBuffer(const StorageBuffer &) = delete;
+    StorageBuffer &operator=(const StorageBuffer &) = delete;
+
+    void upload(const std::vector<T> &data)
+    {
+        reserve(data.size());
+        count = data.size();
+        if (count == 0)
+            return;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, ID);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, count * sizeof(T), data.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    GLuint id() const
+    {
+        return ID;
+    }
+
+    // elements written by the last upload
+    size_t size() const
+    {
+        return count;
+    }
+
+    size_t gpuBytes() const
+    {
+        return capacity * sizeof(T);
+    }
+
+private:
+    GLuint ID;
+    GLuint binding;
+    size_t capacity;
+    size_t count;
+
+    void reserve(size_t elements)
+    {
+        if (elements <= capacity)
+            return;
+        // grow geometrically so a slowly growing light list does not reallocate every frame
+        capacity = capacity * 2 > elements ? capacity * 2 : elements;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, ID);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        // reallocation keeps the buffer name, but rebind so the binding always sees the new store
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, ID);
+    }
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include <glad/glad.h>
+
+// A uniform buffer holding one T, bound to a fixed binding point.
+// T must match the std140 layout of the GLSL block declared with layout (std140, binding = N).
+// Every program declaring the block reads the same buffer, so the data is uploaded once per
+// frame instead of once per program. Needs a current GL context.
+template <typename T>
+class UniformBuffer
+{
+public:
+    explicit UniformBuffer(GLuint binding)
+    {
+        glGenBuffers(1, &ID);
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, ID);
+    }
+
+    ~UniformBuffer()
+    {
+        glDeleteBuffers(1, &ID);
+    }
+
+    UniformBuffer(const UniformBuffer &) = delete;
+    UniformBuffer &operator=(const UniformBuffer &) = delete;
+
+    void upload(const T &data)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    GLuint id() const
+    {
+        return ID;
+    }
+
+private:
+    GLuint ID;
+};
+
+#endif